@@ -0,0 +1,72 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace Sudoku {
+
+namespace {
+// Plain thread_local integers need no constructor, so counting is safe from
+// any thread at any point of its life, including static initialization.
+thread_local std::uint64_t allocations = 0;
+thread_local std::uint64_t allocated_bytes = 0;
+
+void *Allocate(std::size_t size) {
+    size = (size == 0) ? 1 : size;
+
+    for (;;) {
+        void *memory = std::malloc(size);
+        if (memory != nullptr) {
+            ++allocations;
+            allocated_bytes += size;
+            return memory;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+}  // namespace
+
+AllocationCounts ThreadAllocations() {
+    AllocationCounts counts;
+    counts.allocations = allocations;
+    counts.bytes = allocated_bytes;
+    return counts;
+}
+}  // namespace Sudoku
+
+void *operator new(std::size_t size) { return Sudoku::Allocate(size); }
+
+void *operator new[](std::size_t size) { return Sudoku::Allocate(size); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Sudoku::Allocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return Sudoku::Allocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete[](void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Sudoku {
+
+// Heap allocations made by the calling thread. Linking alloc_counter.o into a
+// binary replaces its global operator new and delete with versions that
+// count and then call malloc and free, so only the benchmark and test builds
+// link it; the server keeps the standard allocator.
+struct AllocationCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Totals since the thread started. Take the difference of two reads to
+// count the allocations made in between.
+AllocationCounts ThreadAllocations();
+}  // namespace Sudoku
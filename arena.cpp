@@ -0,0 +1,46 @@
+#include "arena.h"
+
+#include <algorithm>
+
+namespace Sudoku {
+
+void *Arena::Allocate(const std::size_t size, const std::size_t alignment) {
+    while (current_block_ < blocks_.size()) {
+        Block &block = blocks_[current_block_];
+        std::size_t aligned_offset = (offset_ + alignment - 1) & ~(alignment - 1);
+
+        if (aligned_offset + size <= block.size) {
+            offset_ = aligned_offset + size;
+            return block.data.get() + aligned_offset;
+        }
+
+        // doesn't fit, move on to the next block we already own
+        ++current_block_;
+        offset_ = 0;
+    }
+
+    // Out of blocks, grab a new one big enough for this request. Blocks come
+    // from new[] so they're suitably aligned for any fundamental type.
+    std::size_t block_size = std::max(block_size_, size + alignment);
+    blocks_.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[block_size]),
+                            block_size});
+    current_block_ = blocks_.size() - 1;
+    offset_ = size;
+
+    return blocks_.back().data.get();
+}
+
+void Arena::Reset() {
+    current_block_ = 0;
+    offset_ = 0;
+}
+
+std::size_t Arena::BytesReserved() const {
+    std::size_t total = 0;
+    for (auto &block : blocks_) {
+        total += block.size;
+    }
+
+    return total;
+}
+}  // namespace Sudoku
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace Sudoku {
+
+// Bump allocator backing search-time memory (trails, stacks, candidate
+// tables). Allocations are never freed individually; Reset() rewinds the arena
+// so the next puzzle reuses the same blocks, which means that once a batch has
+// warmed up the arena no further heap allocations happen.
+//
+// An arena is not thread safe. Each solver owns its own, so give every thread
+// its own solver.
+class Arena {
+   public:
+    static const std::size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit Arena(const std::size_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    // Returns size bytes aligned to alignment, growing the arena if needed
+    void *Allocate(const std::size_t size, const std::size_t alignment);
+
+    // Rewinds the arena, keeping its blocks for reuse. Anything allocated
+    // from it must no longer be in use.
+    void Reset();
+
+    // Total bytes held by the arena's blocks
+    std::size_t BytesReserved() const;
+
+    // Number of blocks the arena has had to allocate from the heap
+    std::size_t BlockCount() const { return blocks_.size(); }
+
+   private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+
+    std::size_t block_size_;
+    std::vector<Block> blocks_;
+    std::size_t current_block_ = 0;
+    std::size_t offset_ = 0;
+};
+
+// Standard allocator handing out memory from an Arena, so containers used
+// during search can live in the solver's arena. A default constructed
+// allocator (no arena) falls back to the global heap, which lets a container
+// outlive the search it was attached to.
+template <typename T>
+class ArenaAllocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(Arena *arena) noexcept : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena()) {}
+
+    T *allocate(const std::size_t n) {
+        if (arena_ == nullptr) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *pointer, const std::size_t) noexcept {
+        // arena memory is reclaimed all at once by Arena::Reset
+        if (arena_ == nullptr) {
+            ::operator delete(pointer);
+        }
+    }
+
+    // Copies of a container never share the original's arena
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    Arena *arena() const noexcept { return arena_; }
+
+   private:
+    Arena *arena_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &lhs, const ArenaAllocator<U> &rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}  // namespace Sudoku
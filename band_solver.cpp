@@ -0,0 +1,569 @@
+#include "band_solver.h"
+
+#include <array>
+#include <chrono>
+#include <utility>
+
+#include "trace.h"
+
+namespace Sudoku {
+
+namespace {
+using Math = detail::CellMath<3>;
+
+const std::uint32_t kAllCells = (1u << 27) - 1;
+
+// Cells of box j (0-2) within a band
+const std::uint32_t kBandBox = 0x1C0E07;
+
+constexpr int PopCount(const int bits) {
+    int count = 0;
+    for (int b = bits; b != 0; b &= b - 1) {
+        ++count;
+    }
+    return count;
+}
+
+// Peers of the cell that lie in the given band, as a 27 bit band mask
+constexpr std::uint32_t PeerBandMask(const int cell, const int band) {
+    std::uint32_t mask = 0;
+    for (int i = 0; i < 27; ++i) {
+        const int other = band * 27 + i;
+        if (other != cell && (Math::RowOf(other) == Math::RowOf(cell) ||
+                              Math::ColumnOf(other) == Math::ColumnOf(cell) ||
+                              Math::BoxOf(other) == Math::BoxOf(cell))) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+// The nine row segments of a band (three cells of one row inside one box) are
+// numbered 3 * row + box, so segment i covers band bits 3i to 3i + 2.
+
+// Which of the three segments of a 9 bit row hold any bit
+constexpr int Shrink(const int row) {
+    return ((row & 0007) ? 1 : 0) | ((row & 0070) ? 2 : 0) | ((row & 0700) ? 4 : 0);
+}
+
+// Band mask covering the given set of segments
+constexpr std::uint32_t Expand(const int segments) {
+    std::uint32_t mask = 0;
+    for (int i = 0; i < 9; ++i) {
+        if (segments & (1 << i)) {
+            mask |= 7u << (3 * i);
+        }
+    }
+    return mask;
+}
+
+// Applies locked candidates to the segments of a band holding one digit until
+// nothing changes: a box whose digit is confined to one row removes it from
+// that row's other boxes (pointing), and a row whose digit is confined to one
+// box removes it from that box's other rows (claiming).
+constexpr int Locked(const int segments) {
+    int s = segments;
+    int previous = -1;
+    while (s != previous) {
+        previous = s;
+        for (int box = 0; box < 3; ++box) {
+            const int in_box = s & (0111 << box);
+            if (PopCount(in_box) == 1) {
+                for (int row = 0; row < 3; ++row) {
+                    if (in_box & (7 << (3 * row))) {
+                        s &= ~((7 << (3 * row)) & ~in_box);
+                    }
+                }
+            }
+        }
+        for (int row = 0; row < 3; ++row) {
+            const int in_row = s & (7 << (3 * row));
+            if (PopCount(in_row) == 1) {
+                for (int box = 0; box < 3; ++box) {
+                    if (in_row & (0111 << box)) {
+                        s &= ~((0111 << box) & ~in_row);
+                    }
+                }
+            }
+        }
+    }
+    return s;
+}
+
+// Columns are spread over the bands, so the column direction works on the set
+// of columns each band still holds a digit in: bit c for column c, the three
+// columns of a stack (a column of boxes) being bits 3s to 3s + 2.
+
+// Columns of a band's column set that are the only one left in their stack.
+// The digit of that box is in that column, so no other band can have it there
+// (pointing).
+constexpr int Pointing(const int columns) {
+    int pointing = 0;
+    for (int stack = 0; stack < 3; ++stack) {
+        const int in_stack = columns & (7 << (3 * stack));
+        if (PopCount(in_stack) == 1) {
+            pointing |= in_stack;
+        }
+    }
+    return pointing;
+}
+
+// Band cells of the given columns
+inline std::uint32_t ColumnCells(const std::uint32_t columns) { return columns * 0x40201u; }
+
+template <std::size_t... Cells>
+constexpr std::array<std::array<std::uint32_t, 3>, sizeof...(Cells)> MakePeerTable(
+    std::index_sequence<Cells...>) {
+    return {{{{PeerBandMask(Cells, 0), PeerBandMask(Cells, 1), PeerBandMask(Cells, 2)}}...}};
+}
+
+template <std::size_t... Values>
+constexpr std::array<std::uint8_t, sizeof...(Values)> MakeShrinkTable(
+    std::index_sequence<Values...>) {
+    return {{static_cast<std::uint8_t>(Shrink(Values))...}};
+}
+
+template <std::size_t... Values>
+constexpr std::array<std::uint16_t, sizeof...(Values)> MakeLockedTable(
+    std::index_sequence<Values...>) {
+    return {{static_cast<std::uint16_t>(Locked(Values))...}};
+}
+
+template <std::size_t... Values>
+constexpr std::array<std::uint16_t, sizeof...(Values)> MakePointingTable(
+    std::index_sequence<Values...>) {
+    return {{static_cast<std::uint16_t>(Pointing(Values))...}};
+}
+
+template <std::size_t... Values>
+constexpr std::array<std::uint32_t, sizeof...(Values)> MakeExpandTable(
+    std::index_sequence<Values...>) {
+    return {{Expand(Values)...}};
+}
+
+constexpr std::array<std::array<std::uint32_t, 3>, 81> kPeers =
+    MakePeerTable(std::make_index_sequence<81>{});
+constexpr std::array<std::uint8_t, 512> kShrink = MakeShrinkTable(std::make_index_sequence<512>{});
+constexpr std::array<std::uint16_t, 512> kLocked =
+    MakeLockedTable(std::make_index_sequence<512>{});
+constexpr std::array<std::uint32_t, 512> kExpand =
+    MakeExpandTable(std::make_index_sequence<512>{});
+constexpr std::array<std::uint16_t, 512> kPointing =
+    MakePointingTable(std::make_index_sequence<512>{});
+
+inline int LowestBit(const std::uint32_t bits) { return __builtin_ctz(bits); }
+
+inline bool IsSingleBit(const std::uint32_t bits) { return bits != 0 && (bits & (bits - 1)) == 0; }
+}  // namespace
+
+bool BandSolver::Place(State &state, const int digit, const int cell) {
+    const int band = cell / 27;
+    const std::uint32_t bit = 1u << (cell % 27);
+
+    if (!(state.candidates[digit][band] & bit)) {
+        return false;
+    }
+    if (!(state.unsolved[band] & bit)) {
+        // already placed, and only this digit is left there
+        return true;
+    }
+
+    state.unsolved[band] &= ~bit;
+    for (int other = 0; other < 9; ++other) {
+        state.candidates[other][band] &= ~bit;
+    }
+    for (int b = 0; b < 3; ++b) {
+        state.candidates[digit][b] &= ~kPeers[cell][b];
+    }
+    state.candidates[digit][band] |= bit;
+
+    return true;
+}
+
+bool BandSolver::Load(const Puzzle &puzzle, State &state) {
+    for (int digit = 0; digit < 9; ++digit) {
+        for (int band = 0; band < 3; ++band) {
+            state.candidates[digit][band] = kAllCells;
+        }
+    }
+    for (int band = 0; band < 3; ++band) {
+        state.unsolved[band] = kAllCells;
+    }
+
+    for (int cell = 0; cell < 81; ++cell) {
+        const int value = puzzle.GetCell(cell);
+        if (value != kUnassigned && !Place(state, value - 1, cell)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BandSolver::NakedSingles(State &state, bool &changed) {
+    for (int band = 0; band < 3; ++band) {
+        std::uint32_t one = 0;
+        std::uint32_t two = 0;
+        for (int digit = 0; digit < 9; ++digit) {
+            const std::uint32_t c = state.candidates[digit][band];
+            two |= one & c;
+            one |= c;
+        }
+
+        if (state.unsolved[band] & ~one) {
+            // some empty cell has no candidates left
+            return false;
+        }
+
+        // each single is in exactly one plane, so going through the digits
+        // places them without looking each one up
+        const std::uint32_t singles = state.unsolved[band] & ~two;
+        for (int digit = 0; digit < 9 && singles != 0; ++digit) {
+            for (std::uint32_t cells = state.candidates[digit][band] & singles; cells != 0;
+                 cells &= cells - 1) {
+                if (!Place(state, digit, band * 27 + LowestBit(cells))) {
+                    return false;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool BandSolver::UpdateDigit(State &state, const int digit, const std::uint32_t (&seen)[3],
+                             bool &changed) {
+    auto &planes = state.candidates[digit];
+
+    // Locked candidates within each band whose plane changed
+    for (int band = 0; band < 3; ++band) {
+        const std::uint32_t c = planes[band];
+        if (c == seen[band]) {
+            continue;
+        }
+
+        const int segments =
+            kShrink[c & 0x1FF] | (kShrink[(c >> 9) & 0x1FF] << 3) | (kShrink[c >> 18] << 6);
+        const int locked = kLocked[segments];
+        if (locked != segments) {
+            planes[band] = c & kExpand[locked];
+            changed = true;
+        }
+    }
+
+    // The same across the bands, through the columns: a box whose digit is
+    // confined to one column removes it from that column in the other bands,
+    // and a column whose digit is confined to one band removes it from the
+    // rest of its box there
+    std::uint32_t columns[3];
+    for (int band = 0; band < 3; ++band) {
+        const std::uint32_t c = planes[band];
+        columns[band] = (c | (c >> 9) | (c >> 18)) & 0x1FF;
+    }
+
+    for (int band = 0; band < 3; ++band) {
+        const std::uint32_t others = columns[(band + 1) % 3] | columns[(band + 2) % 3];
+        const std::uint32_t pointing = kPointing[columns[band]] & others;
+        const std::uint32_t claiming = columns[band] & ~others;
+        const std::uint32_t claimed = kExpand[kShrink[claiming]] & ~claiming & columns[band];
+
+        if (pointing) {
+            for (int other = 1; other < 3; ++other) {
+                const int b = (band + other) % 3;
+                planes[b] &= ~ColumnCells(pointing);
+                columns[b] &= ~pointing;
+            }
+            changed = true;
+        }
+        if (claimed) {
+            planes[band] &= ~ColumnCells(claimed);
+            columns[band] &= ~claimed;
+            changed = true;
+        }
+    }
+
+    // Hidden singles in the rows and boxes of the bands that changed, all of
+    // a band's found at once
+    for (int band = 0; band < 3; ++band) {
+        const std::uint32_t c = planes[band];
+        if (c == seen[band]) {
+            continue;
+        }
+
+        std::uint32_t singles = 0;
+        bool empty = false;
+        for (int unit = 0; unit < 3; ++unit) {
+            const std::uint32_t row = c & (0x1FFu << (9 * unit));
+            const std::uint32_t box = c & (kBandBox << (3 * unit));
+            empty |= (row == 0) | (box == 0);
+            singles |= (row & (row - 1)) == 0 ? row : 0;
+            singles |= (box & (box - 1)) == 0 ? box : 0;
+        }
+        if (empty) {
+            return false;
+        }
+
+        for (singles &= state.unsolved[band]; singles != 0; singles &= singles - 1) {
+            if (!Place(state, digit, band * 27 + LowestBit(singles))) {
+                return false;
+            }
+            changed = true;
+        }
+    }
+
+    // Columns span the bands, so count each column's bits over all nine rows
+    // at once
+    std::uint32_t one = 0;
+    std::uint32_t two = 0;
+    for (int band = 0; band < 3; ++band) {
+        for (int row = 0; row < 3; ++row) {
+            const std::uint32_t columns = (planes[band] >> (9 * row)) & 0x1FF;
+            two |= one & columns;
+            one |= columns;
+        }
+    }
+    if (~one & 0x1FF) {
+        return false;
+    }
+
+    for (std::uint32_t singles = one & ~two; singles != 0; singles &= singles - 1) {
+        const int column = LowestBit(singles);
+        for (int band = 0; band < 3; ++band) {
+            const std::uint32_t cells = planes[band] & (0x40201u << column);
+            if (cells & state.unsolved[band]) {
+                if (!Place(state, digit, band * 27 + LowestBit(cells))) {
+                    return false;
+                }
+                changed = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool BandSolver::Propagate(State &state, const State *settled) {
+    // Each digit's planes as they were when the digit rules last went over
+    // them. Those rules only look at the digit's own planes, so a digit whose
+    // planes still match has nothing new to give and is skipped. A settled
+    // state (such as the one a guess was made from) counts as gone over.
+    std::uint32_t seen[9][3];
+    for (int digit = 0; digit < 9; ++digit) {
+        for (int band = 0; band < 3; ++band) {
+            seen[digit][band] = settled != nullptr ? settled->candidates[digit][band] : ~0u;
+        }
+    }
+
+    for (;;) {
+        bool changed = false;
+        if (!NakedSingles(state, changed)) {
+            return false;
+        }
+        if (changed) {
+            continue;
+        }
+
+        for (int digit = 0; digit < 9; ++digit) {
+            const auto &planes = state.candidates[digit];
+            if (planes[0] == seen[digit][0] && planes[1] == seen[digit][1] &&
+                planes[2] == seen[digit][2]) {
+                continue;
+            }
+
+            const std::uint32_t before[3] = {planes[0], planes[1], planes[2]};
+            if (!UpdateDigit(state, digit, seen[digit], changed)) {
+                return false;
+            }
+            for (int band = 0; band < 3; ++band) {
+                seen[digit][band] = before[band];
+            }
+        }
+        if (!changed) {
+            return true;
+        }
+    }
+}
+
+void BandSolver::Search(const State &state, const int limit, int &count, State &solution) {
+    if (!(state.unsolved[0] | state.unsolved[1] | state.unsolved[2])) {
+        if (count == 0) {
+            solution = state;
+        }
+        ++count;
+        return;
+    }
+
+    // In lexicographic order, branch on the first open cell; with the digits
+    // tried in ascending order the first solution found is the smallest.
+    // Otherwise branch on a cell with two candidates when there is one, or
+    // else on the cell with the fewest.
+    int cell = -1;
+    for (int band = 0; band < 3 && lexicographic_ && cell < 0; ++band) {
+        if (state.unsolved[band]) {
+            cell = band * 27 + LowestBit(state.unsolved[band]);
+        }
+    }
+
+    for (int band = 0; band < 3 && cell < 0; ++band) {
+        std::uint32_t one = 0;
+        std::uint32_t two = 0;
+        std::uint32_t three = 0;
+        for (int digit = 0; digit < 9; ++digit) {
+            const std::uint32_t c = state.candidates[digit][band];
+            three |= two & c;
+            two |= one & c;
+            one |= c;
+        }
+
+        const std::uint32_t pairs = two & ~three & state.unsolved[band];
+        if (pairs) {
+            cell = band * 27 + LowestBit(pairs);
+        }
+    }
+
+    if (cell < 0) {
+        int best = 10;
+        for (int band = 0; band < 3; ++band) {
+            for (std::uint32_t open = state.unsolved[band]; open != 0; open &= open - 1) {
+                const int index = LowestBit(open);
+                int options = 0;
+                for (int digit = 0; digit < 9; ++digit) {
+                    options += (state.candidates[digit][band] >> index) & 1;
+                }
+                if (options < best) {
+                    best = options;
+                    cell = band * 27 + index;
+                }
+            }
+        }
+    }
+
+    const int band = cell / 27;
+    const std::uint32_t bit = 1u << (cell % 27);
+    for (int digit = 0; digit < 9 && count < limit && !budget_exhausted_; ++digit) {
+        if (!(state.candidates[digit][band] & bit)) {
+            continue;
+        }
+
+        if (node_limit_ != 0 && guesses_ == node_limit_) {
+            budget_exhausted_ = true;
+            return;
+        }
+        ++guesses_;
+        State next = state;
+        if (Place(next, digit, cell) && Propagate(next, &state)) {
+            Search(next, limit, count, solution);
+        }
+    }
+}
+
+bool BandSolver::SolvePuzzle(Puzzle &puzzle) {
+    guesses_ = 0;
+    budget_exhausted_ = false;
+
+    State state;
+    {
+        SUDOKU_TRACE_SCOPE("propagate");
+        if (!Load(puzzle, state) || !Propagate(state)) {
+            return false;
+        }
+    }
+
+    return Finish(state, puzzle);
+}
+
+bool BandSolver::SolvePropagated(const State &propagated, Puzzle &puzzle) {
+    guesses_ = 0;
+    budget_exhausted_ = false;
+
+    if (!RecordingMetrics()) {
+        return Finish(propagated, puzzle);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const bool solved = Finish(propagated, puzzle);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    RecordSolve(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), solved);
+    return solved;
+}
+
+bool BandSolver::Finish(const State &state, Puzzle &puzzle) {
+    int count = 0;
+    State solution;
+    {
+        SUDOKU_TRACE_SCOPE("search");
+        Search(state, 1, count, solution);
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    Store(solution, puzzle);
+    return true;
+}
+
+void BandSolver::Store(const State &state, Puzzle &puzzle) {
+    // each cell is left in exactly one digit's plane
+    for (int digit = 0; digit < 9; ++digit) {
+        for (int band = 0; band < 3; ++band) {
+            for (std::uint32_t cells = state.candidates[digit][band]; cells != 0;
+                 cells &= cells - 1) {
+                const int cell = band * 27 + LowestBit(cells);
+                if (puzzle.GetCell(cell) == kUnassigned) {
+                    puzzle.Assign(cell, digit + 1);
+                }
+            }
+        }
+    }
+}
+
+int BandSolver::CountSolutions(const Puzzle &puzzle, const int limit) {
+    guesses_ = 0;
+    budget_exhausted_ = false;
+
+    State state;
+    {
+        SUDOKU_TRACE_SCOPE("propagate");
+        if (limit <= 0 || !Load(puzzle, state) || !Propagate(state)) {
+            return 0;
+        }
+    }
+
+    int count = 0;
+    State solution;
+    SUDOKU_TRACE_SCOPE("search");
+    Search(state, limit, count, solution);
+    return count;
+}
+
+TriageReport BandSolver::Triage(Puzzle &puzzle, State *propagated) {
+    SUDOKU_TRACE_SCOPE("propagate");
+    TriageReport report;
+
+    State state;
+    if (!Load(puzzle, state) || !Propagate(state)) {
+        report.result = TriageResult::kUnsolvable;
+        return report;
+    }
+
+    if (!(state.unsolved[0] | state.unsolved[1] | state.unsolved[2])) {
+        Store(state, puzzle);
+        report.result = TriageResult::kSolved;
+        return report;
+    }
+
+    for (int digit = 0; digit < 9; ++digit) {
+        for (int band = 0; band < 3; ++band) {
+            report.hardness += static_cast<std::uint32_t>(
+                __builtin_popcount(state.candidates[digit][band] & state.unsolved[band]));
+        }
+    }
+    if (propagated != nullptr) {
+        *propagated = state;
+    }
+
+    return report;
+}
+}  // namespace Sudoku
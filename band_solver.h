@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+
+#include "engine.h"
+#include "puzzle.h"
+
+namespace Sudoku {
+
+enum class TriageResult {
+    // Propagation filled in every cell
+    kSolved,
+    // Propagation ran into a contradiction, or the givens conflict
+    kUnsolvable,
+    // Propagation ran out with cells left to fill
+    kNeedsSearch,
+};
+
+// What a propagation-only pass found out about a puzzle
+struct TriageReport {
+    TriageResult result = TriageResult::kNeedsSearch;
+
+    // Rough estimate of the search a kNeedsSearch puzzle needs: the number of
+    // candidates left across its empty cells once propagation runs out. Only
+    // meaningful for comparing puzzles; 0 for the other results.
+    std::uint32_t hardness = 0;
+};
+
+// Bit-parallel solver for 9x9 puzzles, in the style of the fast "band"
+// solvers. The board is kept as nine digit planes of 81 bits, each split into
+// three 27 bit words, one per band of three rows. A set bit means the digit is
+// still possible in that cell (or is placed there). Propagation works on whole
+// planes at once: naked and hidden singles are found by counting bits across
+// planes and units, and locked candidates within a band come from lookup
+// tables indexed by which row segments of the band still hold the digit.
+//
+// This is much faster than Solver on hard puzzles and is meant for bulk work
+// such as checking that a puzzle has a unique solution. Like the other engines
+// it must only be used by one thread at a time.
+class BandSolver : public Engine {
+   public:
+    // The board as bit planes, during or after propagation
+    struct State {
+        // candidates[digit][band], bit (row in band) * 9 + column
+        std::uint32_t candidates[9][3];
+        // cells of each band without a placed digit
+        std::uint32_t unsolved[3];
+    };
+
+    const char *Name() const override { return "band"; }
+
+    // Attempts to solve a single puzzle, and returns true if it was able to be
+    // solved.
+    bool SolvePuzzle(Puzzle &puzzle) override;
+
+    // Counts the solutions of the puzzle, stopping once limit have been found.
+    // CountSolutions(puzzle, 2) == 1 means the puzzle is unique. With a node
+    // limit the count may fall short; check LastBudgetExhausted.
+    int CountSolutions(const Puzzle &puzzle, const int limit);
+
+    // Runs the propagation alone, without guessing. That finishes most
+    // newspaper puzzles in a couple of microseconds and sizes up the rest, so
+    // a scheduler can start the hardest first. A solved puzzle is filled in;
+    // any other puzzle is left as it was. For a kNeedsSearch puzzle the
+    // propagated board is copied to propagated, if given, so SolvePropagated
+    // can pick it up without propagating again.
+    TriageReport Triage(Puzzle &puzzle, State *propagated = nullptr);
+
+    // Solves a puzzle Triage found kNeedsSearch, searching from the board it
+    // handed back. Recorded in the attached metrics like SolveRecorded.
+    bool SolvePropagated(const State &propagated, Puzzle &puzzle);
+
+    // Branches on the first open cell instead of the most constrained one,
+    // which costs some guesses on hard puzzles
+    bool SetLexicographic(const bool lexicographic) override {
+        lexicographic_ = lexicographic;
+        return true;
+    }
+
+    // Number of guesses made by the last solve or count
+    std::uint64_t GuessCount() const { return guesses_; }
+
+    std::uint64_t LastNodes() const override { return guesses_; }
+
+   private:
+    std::uint64_t guesses_ = 0;
+    bool lexicographic_ = false;
+
+    static bool Load(const Puzzle &puzzle, State &state);
+    // Fills the puzzle's empty cells from a solved state
+    static void Store(const State &state, Puzzle &puzzle);
+    static bool Place(State &state, const int digit, const int cell);
+    // Propagates to a fixed point. settled, if given, is a state already
+    // propagated that this one was derived from; planes still equal to it
+    // there are not gone over again.
+    static bool Propagate(State &state, const State *settled = nullptr);
+    static bool NakedSingles(State &state, bool &changed);
+    // Locked candidates and hidden singles of one digit, skipping the bands
+    // whose plane still equals seen
+    static bool UpdateDigit(State &state, const int digit, const std::uint32_t (&seen)[3],
+                            bool &changed);
+
+    // Searches from a propagated state and fills in the puzzle if that finds
+    // a solution
+    bool Finish(const State &state, Puzzle &puzzle);
+
+    // Depth first search from a propagated state. Stops once limit solutions
+    // have been counted; the first solution found is kept in solution.
+    void Search(const State &state, const int limit, int &count, State &solution);
+};
+}  // namespace Sudoku
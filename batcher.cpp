@@ -0,0 +1,279 @@
+#include "batcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "band_solver.h"
+
+namespace Sudoku {
+
+ShedPolicy ParseShedPolicy(const std::string &name) {
+    if (name == "reject") {
+        return ShedPolicy::kReject;
+    }
+    if (name == "drop-oldest") {
+        return ShedPolicy::kDropOldest;
+    }
+    if (name == "degrade") {
+        return ShedPolicy::kDegrade;
+    }
+
+    throw std::invalid_argument("Unknown shed policy: " + name);
+}
+
+void Completion::Done() {
+    // The owner may free this as soon as the count hits zero, so the callback
+    // runs from a copy, outside the lock
+    std::function<void()> on_done;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--remaining_ != 0) {
+            return;
+        }
+        on_done = on_done_;
+        done_.notify_all();
+    }
+
+    if (on_done) {
+        on_done();
+    }
+}
+
+void Completion::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return remaining_ == 0; });
+}
+
+SolveBatcher::SolveBatcher(const std::string &engine, const unsigned threads,
+                           const BatchOptions &options)
+    : options_(options), pool_(threads) {
+    options_.max_batch_size = std::max<std::size_t>(1, options_.max_batch_size);
+
+    for (unsigned worker = 0; worker < pool_.Size(); ++worker) {
+        engines_.push_back(MakeEngine(engine));
+        if (!engines_.back()) {
+            throw std::invalid_argument("Unknown engine: " + engine);
+        }
+        if (!engines_.back()->SetLexicographic(options_.deterministic)) {
+            throw std::invalid_argument("Engine " + engine + " has no deterministic mode");
+        }
+    }
+
+    band_engines_ = (engine == "band");
+
+    // one shard per worker
+    metrics_.reset(new EngineMetrics(engines_[0]->Name(), pool_.Size()));
+    for (unsigned worker = 0; worker < pool_.Size(); ++worker) {
+        engines_[worker]->AttachMetrics(metrics_.get(), worker);
+    }
+
+    if (options_.shed_policy == ShedPolicy::kDegrade) {
+        degrade_engine_ = MakeEngine(options_.degrade_engine);
+        if (!degrade_engine_) {
+            throw std::invalid_argument("Unknown engine: " + options_.degrade_engine);
+        }
+        if (!degrade_engine_->SetLexicographic(options_.deterministic)) {
+            throw std::invalid_argument("Engine " + options_.degrade_engine +
+                                        " has no deterministic mode");
+        }
+        degrade_engine_->SetNodeLimit(options_.degrade_node_limit);
+
+        degrade_metrics_.reset(new EngineMetrics(degrade_engine_->Name(), 1));
+        degrade_engine_->AttachMetrics(degrade_metrics_.get(), 0);
+    }
+
+    dispatcher_ = std::thread(&SolveBatcher::Dispatch, this);
+}
+
+SolveBatcher::~SolveBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    arrived_.notify_all();
+    dispatcher_.join();
+}
+
+void SolveBatcher::Submit(SolveRequest *request, Completion *completion) {
+    request->shed = false;
+
+    Pending shed{nullptr, nullptr, {}};
+    bool admitted = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Pending pending{request, completion, std::chrono::steady_clock::now()};
+
+        if (options_.max_pending == 0 || stats_.pending < options_.max_pending) {
+            queue_.push_back(pending);
+            ++stats_.pending;
+            stats_.peak_pending = std::max(stats_.peak_pending, stats_.pending);
+            ++stats_.admitted;
+            admitted = true;
+        } else if (options_.shed_policy == ShedPolicy::kDropOldest && !queue_.empty()) {
+            shed = queue_.front();
+            queue_.pop_front();
+            queue_.push_back(pending);
+            ++stats_.dropped;
+            ++stats_.admitted;
+            admitted = true;
+        } else if (options_.shed_policy == ShedPolicy::kDegrade) {
+            ++stats_.degraded;
+        } else {
+            shed = pending;
+            ++stats_.rejected;
+        }
+    }
+
+    // completions are signalled outside the lock, since they may call back
+    // into the submitter
+    if (admitted) {
+        arrived_.notify_one();
+    } else if (shed.request == nullptr) {
+        SolveDegraded(request, completion);
+    }
+
+    if (shed.request != nullptr) {
+        shed.request->solved = false;
+        shed.request->shed = true;
+        shed.completion->Done();
+    }
+}
+
+void SolveBatcher::SolveDegraded(SolveRequest *request, Completion *completion) {
+    {
+        std::lock_guard<std::mutex> lock(degrade_mutex_);
+        request->solved = degrade_engine_->SolveRecorded(request->puzzle);
+        request->shed = !request->solved && degrade_engine_->LastBudgetExhausted();
+    }
+
+    completion->Done();
+}
+
+std::size_t SolveBatcher::BatchCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return batches_;
+}
+
+BatcherStats SolveBatcher::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BatcherStats stats = stats_;
+    stats.queued = queue_.size();
+    return stats;
+}
+
+void SolveBatcher::Dispatch() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        arrived_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;
+        }
+
+        // hold the batch open until it fills up or its first puzzle has
+        // waited long enough
+        arrived_.wait_until(lock, queue_.front().queued + options_.max_wait, [this] {
+            return stopping_ || queue_.size() >= options_.max_batch_size;
+        });
+
+        const std::size_t size = std::min(queue_.size(), options_.max_batch_size);
+        auto batch = std::make_shared<Batch>();
+        batch->puzzles.assign(queue_.begin(), queue_.begin() + size);
+        queue_.erase(queue_.begin(), queue_.begin() + size);
+        ++batches_;
+        lock.unlock();
+
+        if (options_.triage) {
+            batch->hardness.assign(size, 0);
+            if (band_engines_) {
+                batch->propagated.resize(size);
+            }
+            const std::size_t workers = std::min<std::size_t>(pool_.Size(), size);
+            batch->triaging = workers;
+            for (std::size_t share = 0; share < workers; ++share) {
+                pool_.Submit([this, batch](const unsigned) { Triage(batch); });
+            }
+        } else {
+            for (std::size_t i = 0; i < size; ++i) {
+                batch->searches.push_back(i);
+            }
+            StartSolving(batch);
+        }
+
+        lock.lock();
+    }
+}
+
+void SolveBatcher::Triage(const std::shared_ptr<Batch> &batch) {
+    // propagation only, so there's nothing worth keeping warm between batches
+    BandSolver band;
+
+    for (std::size_t i = batch->next.fetch_add(1); i < batch->puzzles.size();
+         i = batch->next.fetch_add(1)) {
+        const Pending &pending = batch->puzzles[i];
+        const TriageReport report = band.Triage(
+            pending.request->puzzle, band_engines_ ? &batch->propagated[i] : nullptr);
+        if (report.result == TriageResult::kNeedsSearch) {
+            batch->hardness[i] = report.hardness;
+            continue;
+        }
+
+        pending.request->solved = (report.result == TriageResult::kSolved);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --stats_.pending;
+            ++stats_.triaged;
+        }
+        pending.completion->Done();
+    }
+
+    // the last worker through hands the rest out hardest first
+    if (batch->triaging.fetch_sub(1) != 1) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < batch->puzzles.size(); ++i) {
+        if (batch->hardness[i] != 0) {
+            batch->searches.push_back(i);
+        }
+    }
+    // stable, so equally hard puzzles keep their arrival order
+    std::stable_sort(batch->searches.begin(), batch->searches.end(),
+                     [&batch](const std::size_t a, const std::size_t b) {
+                         return batch->hardness[a] > batch->hardness[b];
+                     });
+
+    StartSolving(batch);
+}
+
+void SolveBatcher::StartSolving(const std::shared_ptr<Batch> &batch) {
+    batch->next = 0;
+
+    const std::size_t workers = std::min<std::size_t>(pool_.Size(), batch->searches.size());
+    for (std::size_t share = 0; share < workers; ++share) {
+        pool_.Submit([this, batch](const unsigned worker) { Solve(worker, *batch); });
+    }
+}
+
+void SolveBatcher::Solve(const unsigned worker, Batch &batch) {
+    Engine &engine = *engines_[worker];
+
+    for (std::size_t i = batch.next.fetch_add(1); i < batch.searches.size();
+         i = batch.next.fetch_add(1)) {
+        const std::size_t index = batch.searches[i];
+        const Pending &pending = batch.puzzles[index];
+        if (batch.propagated.empty()) {
+            pending.request->solved = engine.SolveRecorded(pending.request->puzzle);
+        } else {
+            pending.request->solved = static_cast<BandSolver &>(engine).SolvePropagated(
+                batch.propagated[index], pending.request->puzzle);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --stats_.pending;
+        }
+        pending.completion->Done();
+    }
+}
+}  // namespace Sudoku
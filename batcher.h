@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "band_solver.h"
+#include "engine.h"
+#include "metrics.h"
+#include "puzzle.h"
+#include "thread_pool.h"
+
+namespace Sudoku {
+
+// What the batcher does with a puzzle submitted while max_pending puzzles
+// are already queued or being solved
+enum class ShedPolicy {
+    // Shed the new puzzle
+    kReject,
+    // Shed the puzzle that has been queued longest to make room for the new
+    // one. Puzzles already being solved can't be dropped, so if none are
+    // queued the new puzzle is shed instead.
+    kDropOldest,
+    // Solve the new puzzle straight away on the submitting thread with the
+    // degrade engine, shedding it if the node limit runs out. This slows the
+    // submitter down instead of letting the queue grow.
+    kDegrade,
+};
+
+// Returns the policy called name ("reject", "drop-oldest" or "degrade").
+// Throws std::invalid_argument for other names.
+ShedPolicy ParseShedPolicy(const std::string &name);
+
+struct BatchOptions {
+    // Most puzzles dispatched together
+    std::size_t max_batch_size = 64;
+
+    // Longest a puzzle waits for others to join its batch
+    std::chrono::microseconds max_wait{200};
+
+    // Most puzzles queued or being solved at once, or 0 for no limit
+    std::size_t max_pending = 1 << 16;
+
+    ShedPolicy shed_policy = ShedPolicy::kReject;
+
+    // Engine and per-puzzle node limit (see BasicEngine::SetNodeLimit) used
+    // by ShedPolicy::kDegrade
+    std::string degrade_engine = "band";
+    std::uint64_t degrade_node_limit = 32;
+
+    // Run each batch through BandSolver::Triage first, finishing what
+    // propagation can without an engine and handing out the rest hardest
+    // first. The "band" engine carries on from the propagated boards, so
+    // triage costs it nothing; other engines propagate again.
+    bool triage = true;
+
+    // Give every puzzle its lexicographically first solution (see
+    // BasicEngine::SetLexicographic), so a puzzle with several solutions is
+    // answered the same whatever the thread count, scheduling or load. Triage
+    // only finishes puzzles with a single solution, so it stays on. Both
+    // engines must support it.
+    bool deterministic = false;
+};
+
+// Queue depths and admission counts of a SolveBatcher
+struct BatcherStats {
+    // Puzzles waiting to join a batch
+    std::size_t queued = 0;
+    // Puzzles queued or being solved
+    std::size_t pending = 0;
+    // Highest pending seen
+    std::size_t peak_pending = 0;
+
+    // Puzzles taken into the queue
+    std::uint64_t admitted = 0;
+    // Puzzles shed on submission
+    std::uint64_t rejected = 0;
+    // Queued puzzles shed to make room for newer ones
+    std::uint64_t dropped = 0;
+    // Puzzles solved on the submitting thread by the degrade engine
+    std::uint64_t degraded = 0;
+    // Puzzles finished by triage without reaching an engine
+    std::uint64_t triaged = 0;
+};
+
+// Counts down outstanding solves so a caller can wait for a group of them,
+// or be called back once the last one is done
+class Completion {
+   public:
+    explicit Completion(const std::size_t count, std::function<void()> on_done = nullptr)
+        : remaining_(count), on_done_(std::move(on_done)) {}
+
+    // Marks one solve done. The last one runs on_done on the calling thread.
+    void Done();
+
+    void Wait();
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::size_t remaining_;
+    std::function<void()> on_done_;
+};
+
+// A puzzle waiting to be solved. The batcher solves it in place.
+struct SolveRequest {
+    Puzzle puzzle;
+    bool solved = false;
+    // Set instead of solving when the batcher sheds the puzzle under load
+    bool shed = false;
+};
+
+// Coalesces puzzles submitted from any number of threads into micro-batches.
+// A batch is dispatched when it reaches max_batch_size or when its oldest
+// puzzle has waited max_wait. Batching keeps the workers' engines, arenas and
+// caches busy with runs of work instead of one puzzle at a time.
+//
+// The workers first share a propagation-only pass over the batch
+// (BandSolver::Triage), which finishes the puzzles that need no search and
+// estimates how hard the rest are. Those are then ordered hardest first, and
+// each worker takes the next one with its own engine as soon as it's free
+// (longest processing time first scheduling), so one hard puzzle can't hold
+// up the end of a batch while the other workers sit idle.
+//
+// Every request is solved in place, so callers get answers back in whatever
+// order they submitted them in; with BatchOptions::deterministic the answers
+// themselves don't depend on which worker ran them either.
+//
+// At most max_pending puzzles are queued or being solved at once. Past that,
+// new puzzles are handled according to the shed policy, so a load spike
+// costs some answers instead of unbounded memory and latency.
+class SolveBatcher {
+   public:
+    // Throws std::invalid_argument for an unknown engine or degrade engine,
+    // or one without a lexicographic order in deterministic mode
+    SolveBatcher(const std::string &engine, const unsigned threads, const BatchOptions &options);
+
+    // Dispatches whatever is queued, then stops
+    ~SolveBatcher();
+
+    SolveBatcher(const SolveBatcher &) = delete;
+    SolveBatcher &operator=(const SolveBatcher &) = delete;
+
+    // Queues a request; completion->Done() is called once it's solved or
+    // shed, possibly before Submit returns. Both must stay alive until then.
+    void Submit(SolveRequest *request, Completion *completion);
+
+    unsigned Workers() const { return pool_.Size(); }
+
+    // Number of batches dispatched so far
+    std::size_t BatchCount() const;
+
+    BatcherStats Stats() const;
+
+    // Solves run by the workers
+    const EngineMetrics &Metrics() const { return *metrics_; }
+
+    // Solves run by the degrade engine, or null unless the shed policy is
+    // ShedPolicy::kDegrade
+    const EngineMetrics *DegradeMetrics() const { return degrade_metrics_.get(); }
+
+   private:
+    struct Pending {
+        SolveRequest *request;
+        Completion *completion;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // A dispatched batch, shared by the workers triaging and solving it
+    struct Batch {
+        std::vector<Pending> puzzles;
+        // TriageReport::hardness of each puzzle, 0 once triage finished it
+        std::vector<std::uint32_t> hardness;
+        // boards triage propagated, kept for band engines
+        std::vector<BandSolver::State> propagated;
+        // indices of the puzzles left for the engines, in the order they're
+        // taken
+        std::vector<std::size_t> searches;
+        // next puzzle to triage, then next search to take
+        std::atomic<std::size_t> next{0};
+        // workers still triaging
+        std::atomic<std::size_t> triaging{0};
+    };
+
+    BatchOptions options_;
+
+    std::vector<std::unique_ptr<Engine>> engines_;
+    // the engines are BandSolvers, which can search from triaged boards
+    bool band_engines_ = false;
+    std::unique_ptr<EngineMetrics> metrics_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable arrived_;
+    std::deque<Pending> queue_;
+    std::size_t batches_ = 0;
+    bool stopping_ = false;
+    BatcherStats stats_;
+
+    // used by ShedPolicy::kDegrade, one submitter at a time
+    std::mutex degrade_mutex_;
+    std::unique_ptr<Engine> degrade_engine_;
+    std::unique_ptr<EngineMetrics> degrade_metrics_;
+
+    ThreadPool pool_;
+    std::thread dispatcher_;
+
+    void Dispatch();
+    void Triage(const std::shared_ptr<Batch> &batch);
+    void StartSolving(const std::shared_ptr<Batch> &batch);
+    void SolveDegraded(SolveRequest *request, Completion *completion);
+    void Solve(const unsigned worker, Batch &batch);
+};
+}  // namespace Sudoku
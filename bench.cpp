@@ -0,0 +1,175 @@
+#include "engine.h"
+#include "generator.h"
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Runs each engine over a corpus of puzzles and reports throughput, plus
+// hardware counters per solved puzzle when asked for (and available).
+namespace {
+struct Result {
+  std::string engine;
+  std::size_t solved = 0;
+  std::size_t puzzles = 0;
+  double seconds = 0;
+  Sudoku::PerfSample counters;
+};
+
+// Counter totals divided by the solved puzzles, or "-" where there's nothing
+// to show
+std::string PerSolved(const Result& result, const Sudoku::PerfEvent event) {
+  if (!result.counters.Has(event) || result.solved == 0) {
+    return "-";
+  }
+
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.1f",
+                static_cast<double>(result.counters[event]) / result.solved);
+  return text;
+}
+
+std::string Ipc(const Result& result) {
+  using Sudoku::PerfEvent;
+  if (!result.counters.Has(PerfEvent::kCycles) || !result.counters.Has(PerfEvent::kInstructions) ||
+      result.counters[PerfEvent::kCycles] == 0) {
+    return "-";
+  }
+
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.2f",
+                static_cast<double>(result.counters[PerfEvent::kInstructions]) /
+                    result.counters[PerfEvent::kCycles]);
+  return text;
+}
+
+Result Run(Sudoku::Engine& engine, const std::vector<Sudoku::Puzzle>& corpus, const int repeat,
+           Sudoku::PerfCounters* counters) {
+  Result result;
+  result.engine = engine.Name();
+
+  // one warm-up pass, so arenas and caches are in their steady state
+  std::vector<Sudoku::Puzzle> puzzles = corpus;
+  engine.SolvePuzzles(puzzles);
+
+  for (int pass = 0; pass < repeat; ++pass) {
+    puzzles = corpus;
+
+    if (counters != nullptr) {
+      counters->Start();
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<bool> solved = engine.SolvePuzzles(puzzles);
+    result.seconds +=
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (counters != nullptr) {
+      Sudoku::PerfSample sample = counters->Stop();
+      for (int event = 0; event < Sudoku::kPerfEventCount; ++event) {
+        result.counters.counts[event] += sample.counts[event];
+        result.counters.available[event] = sample.available[event];
+      }
+    }
+
+    for (const bool puzzle_solved : solved) {
+      result.solved += puzzle_solved ? 1 : 0;
+    }
+    result.puzzles += puzzles.size();
+  }
+
+  return result;
+}
+
+void PrintUsage() {
+  std::cerr << "usage: bench [--engines NAME,...] [--repeat N] [--perf] [CORPUS]" << std::endl
+            << "  Engines default to backtrack,band,sat,logic,lockstep and the corpus to corpus.spf."
+            << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::vector<std::string> engines{"backtrack", "band", "sat", "logic", "lockstep"};
+  std::string corpus_path = "corpus.spf";
+  int repeat = 3;
+  bool perf = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--perf") {
+      perf = true;
+    } else if (argument == "--engines" && i + 1 < argc) {
+      engines.clear();
+      std::istringstream names(argv[++i]);
+      for (std::string name; std::getline(names, name, ',');) {
+        engines.push_back(name);
+      }
+    } else if (argument == "--repeat" && i + 1 < argc) {
+      repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (!argument.empty() && argument[0] != '-') {
+      corpus_path = argument;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  std::vector<Sudoku::Puzzle> corpus;
+  try {
+    std::ifstream input(corpus_path);
+    if (!input) {
+      throw std::runtime_error("can't open " + corpus_path);
+    }
+    corpus = Sudoku::Generator::ReadPuzzles(input);
+  } catch (const std::exception& e) {
+    std::cerr << "Could not read corpus: " << e.what() << std::endl;
+    return 1;
+  }
+
+  Sudoku::PerfCounters counters;
+  if (perf && !counters.Available()) {
+    std::cout << "Hardware counters unavailable (" << counters.Error() << ")" << std::endl;
+  }
+  Sudoku::PerfCounters* used_counters = (perf && counters.Available()) ? &counters : nullptr;
+
+  std::cout << corpus_path << ": " << corpus.size() << " puzzles, " << repeat << " passes"
+            << std::endl;
+
+  std::printf("%-10s %8s %12s %10s", "engine", "solved", "puzzles/s", "us/puzzle");
+  if (used_counters != nullptr) {
+    std::printf(" %6s %14s %14s %14s %14s", "IPC", "instr/solved", "br-miss/solved",
+                "L1-miss/solved", "LLC-miss/solved");
+  }
+  std::printf("\n");
+
+  for (const auto& name : engines) {
+    std::unique_ptr<Sudoku::Engine> engine = Sudoku::MakeEngine(name);
+    if (!engine) {
+      std::cerr << "Unknown engine: " << name << std::endl;
+      return 1;
+    }
+
+    Result result = Run(*engine, corpus, repeat, used_counters);
+    std::printf("%-10s %8zu %12.0f %10.2f", result.engine.c_str(), result.solved / repeat,
+                result.puzzles / result.seconds, 1e6 * result.seconds / result.puzzles);
+    if (used_counters != nullptr) {
+      using Sudoku::PerfEvent;
+      std::printf(" %6s %14s %14s %14s %14s", Ipc(result).c_str(),
+                  PerSolved(result, PerfEvent::kInstructions).c_str(),
+                  PerSolved(result, PerfEvent::kBranchMisses).c_str(),
+                  PerSolved(result, PerfEvent::kL1DataMisses).c_str(),
+                  PerSolved(result, PerfEvent::kLastLevelMisses).c_str());
+    }
+    std::printf("\n");
+  }
+
+  return 0;
+}
@@ -0,0 +1,229 @@
+#include "candidates.h"
+
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SUDOKU_X86_KERNELS 1
+#endif
+
+namespace Sudoku {
+
+namespace {
+template <int BoxSize>
+void ComputeCandidatesScalar(const std::uint8_t *cells,
+                             const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                             CandidateTable<BoxSize> &table) {
+    using Geometry = BoardGeometry<BoxSize>;
+    using Mask_t = typename Geometry::Mask_t;
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        Mask_t used = unit_masks[Geometry::kRowOf[cell]] |
+                      unit_masks[Geometry::kBoardSize + Geometry::kColumnOf[cell]] |
+                      unit_masks[2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]];
+
+        table.masks[cell] =
+            (cells[cell] == 0) ? static_cast<Mask_t>(Geometry::kAllValues & ~used) : Mask_t{0};
+    }
+}
+
+#ifdef SUDOKU_X86_KERNELS
+// The vector kernels handle one row at a time: the column masks of a row are
+// contiguous in unit_masks, the row mask is broadcast, and the box masks are
+// shuffled once per band so lane c holds the mask of the box containing
+// column c. Rows are stored with unaligned stores in increasing order, so the
+// lanes past the end of a row are overwritten by the next row.
+
+// Byte shuffle control that spreads the box masks of one band (the first
+// BoxSize 16 bit values of the source) across 16 lanes, one per column. Lanes
+// past the end of the row are zeroed.
+constexpr char BoxShuffleByte(const int box_size, const int byte) {
+    return (byte / 2 >= box_size * box_size)
+               ? static_cast<char>(0x80)
+               : static_cast<char>(2 * ((byte / 2) / box_size) + byte % 2);
+}
+
+template <int BoxSize, std::size_t... Bytes>
+__attribute__((target("avx2"))) __m256i BoxShuffleAvx2(std::index_sequence<Bytes...>) {
+    return _mm256_setr_epi8(BoxShuffleByte(BoxSize, Bytes)...);
+}
+
+template <int BoxSize, std::size_t... Bytes>
+__attribute__((target("sse4.1"))) __m128i BoxShuffleSse4(const int half,
+                                                         std::index_sequence<Bytes...>) {
+    return _mm_setr_epi8(BoxShuffleByte(BoxSize, 16 * half + Bytes)...);
+}
+
+template <int BoxSize>
+__attribute__((target("avx2"))) void ComputeCandidatesAvx2(const std::uint8_t *cells,
+                                                           const std::uint16_t *unit_masks,
+                                                           std::uint16_t *out) {
+    const int kBoardSize = BoxSize * BoxSize;
+    const __m256i box_shuffle = BoxShuffleAvx2<BoxSize>(std::make_index_sequence<32>{});
+
+    const __m256i all_values =
+        _mm256_set1_epi16(static_cast<short>(BoardGeometry<BoxSize>::kAllValues));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i columns =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(unit_masks + kBoardSize));
+
+    for (int band = 0; band < BoxSize; ++band) {
+        const __m256i boxes = _mm256_shuffle_epi8(
+            _mm256_broadcastsi128_si256(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(
+                unit_masks + 2 * kBoardSize + band * BoxSize))),
+            box_shuffle);
+        const __m256i columns_and_boxes = _mm256_or_si256(columns, boxes);
+
+        for (int row = band * BoxSize; row < (band + 1) * BoxSize; ++row) {
+            __m256i used = _mm256_or_si256(columns_and_boxes,
+                                           _mm256_set1_epi16(static_cast<short>(unit_masks[row])));
+            __m256i values = _mm256_cvtepu8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + row * kBoardSize)));
+            __m256i empty = _mm256_cmpeq_epi16(values, zero);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + row * kBoardSize),
+                                _mm256_and_si256(_mm256_andnot_si256(used, all_values), empty));
+        }
+    }
+}
+
+template <int BoxSize>
+__attribute__((target("sse4.1"))) void ComputeCandidatesSse4(const std::uint8_t *cells,
+                                                             const std::uint16_t *unit_masks,
+                                                             std::uint16_t *out) {
+    const int kBoardSize = BoxSize * BoxSize;
+    const __m128i box_shuffle_low = BoxShuffleSse4<BoxSize>(0, std::make_index_sequence<16>{});
+    const __m128i box_shuffle_high = BoxShuffleSse4<BoxSize>(1, std::make_index_sequence<16>{});
+
+    const __m128i all_values =
+        _mm_set1_epi16(static_cast<short>(BoardGeometry<BoxSize>::kAllValues));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i columns_low =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(unit_masks + kBoardSize));
+    const __m128i columns_high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(unit_masks + kBoardSize + 8));
+
+    for (int band = 0; band < BoxSize; ++band) {
+        const __m128i boxes = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i *>(unit_masks + 2 * kBoardSize + band * BoxSize));
+        const __m128i low = _mm_or_si128(columns_low, _mm_shuffle_epi8(boxes, box_shuffle_low));
+        const __m128i high = _mm_or_si128(columns_high, _mm_shuffle_epi8(boxes, box_shuffle_high));
+
+        for (int row = band * BoxSize; row < (band + 1) * BoxSize; ++row) {
+            const __m128i row_mask = _mm_set1_epi16(static_cast<short>(unit_masks[row]));
+            const __m128i values =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(cells + row * kBoardSize));
+
+            __m128i empty = _mm_cmpeq_epi16(_mm_cvtepu8_epi16(values), zero);
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i *>(out + row * kBoardSize),
+                _mm_and_si128(_mm_andnot_si128(_mm_or_si128(low, row_mask), all_values), empty));
+
+            empty = _mm_cmpeq_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(values, 8)), zero);
+            _mm_storeu_si128(
+                reinterpret_cast<__m128i *>(out + row * kBoardSize + 8),
+                _mm_and_si128(_mm_andnot_si128(_mm_or_si128(high, row_mask), all_values), empty));
+        }
+    }
+}
+#endif
+
+// Picks a kernel for boards with 16 bit masks
+template <int BoxSize, bool kVectorizable = (BoxSize * BoxSize <= 16)>
+struct CandidateKernels {
+    static void Compute(const CandidateKernel kernel, const std::uint8_t *cells,
+                        const std::uint16_t *unit_masks, CandidateTable<BoxSize> &table) {
+#ifdef SUDOKU_X86_KERNELS
+        switch (kernel) {
+            case CandidateKernel::kAvx2:
+                ComputeCandidatesAvx2<BoxSize>(cells, unit_masks, table.masks.data());
+                return;
+            case CandidateKernel::kSse4:
+                ComputeCandidatesSse4<BoxSize>(cells, unit_masks, table.masks.data());
+                return;
+            case CandidateKernel::kScalar:
+                break;
+        }
+#else
+        (void)kernel;
+#endif
+        ComputeCandidatesScalar<BoxSize>(cells, unit_masks, table);
+    }
+};
+
+// Boards with wider masks only have the scalar kernel
+template <int BoxSize>
+struct CandidateKernels<BoxSize, false> {
+    static void Compute(const CandidateKernel, const std::uint8_t *cells,
+                        const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                        CandidateTable<BoxSize> &table) {
+        ComputeCandidatesScalar<BoxSize>(cells, unit_masks, table);
+    }
+};
+
+CandidateKernel DetectKernel() {
+#ifdef SUDOKU_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return CandidateKernel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return CandidateKernel::kSse4;
+    }
+#endif
+    return CandidateKernel::kScalar;
+}
+}  // namespace
+
+CandidateKernel DetectCandidateKernel() {
+    static const CandidateKernel kernel = DetectKernel();
+    return kernel;
+}
+
+const char *CandidateKernelName(const CandidateKernel kernel) {
+    switch (kernel) {
+        case CandidateKernel::kAvx2:
+            return "avx2";
+        case CandidateKernel::kSse4:
+            return "sse4.1";
+        case CandidateKernel::kScalar:
+            break;
+    }
+
+    return "scalar";
+}
+
+template <int BoxSize>
+void ComputeCandidates(const CandidateKernel kernel, const std::uint8_t *cells,
+                       const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                       CandidateTable<BoxSize> &table) {
+    // Never run a kernel the CPU doesn't have
+    CandidateKernel supported = DetectCandidateKernel();
+    CandidateKernel chosen = (static_cast<int>(kernel) <= static_cast<int>(supported))
+                                 ? kernel
+                                 : CandidateKernel::kScalar;
+
+    CandidateKernels<BoxSize>::Compute(chosen, cells, unit_masks, table);
+}
+
+template <int BoxSize>
+void ComputeCandidates(const std::uint8_t *cells,
+                       const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                       CandidateTable<BoxSize> &table) {
+    CandidateKernels<BoxSize>::Compute(DetectCandidateKernel(), cells, unit_masks, table);
+}
+
+template void ComputeCandidates<3>(const CandidateKernel, const std::uint8_t *,
+                                   const BoardGeometry<3>::Mask_t *, CandidateTable<3> &);
+template void ComputeCandidates<4>(const CandidateKernel, const std::uint8_t *,
+                                   const BoardGeometry<4>::Mask_t *, CandidateTable<4> &);
+template void ComputeCandidates<5>(const CandidateKernel, const std::uint8_t *,
+                                   const BoardGeometry<5>::Mask_t *, CandidateTable<5> &);
+
+template void ComputeCandidates<3>(const std::uint8_t *, const BoardGeometry<3>::Mask_t *,
+                                   CandidateTable<3> &);
+template void ComputeCandidates<4>(const std::uint8_t *, const BoardGeometry<4>::Mask_t *,
+                                   CandidateTable<4> &);
+template void ComputeCandidates<5>(const std::uint8_t *, const BoardGeometry<5>::Mask_t *,
+                                   CandidateTable<5> &);
+}  // namespace Sudoku
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "geometry.h"
+
+namespace Sudoku {
+
+// Implementations of the all-cells candidate computation. The vector kernels
+// only exist for boards whose masks fit in 16 bits (9x9 and 16x16); larger
+// boards always use the scalar kernel.
+enum class CandidateKernel { kScalar, kSse4, kAvx2 };
+
+// Returns the fastest kernel this CPU supports. Detected once, at first use.
+CandidateKernel DetectCandidateKernel();
+
+// Returns a printable name for the kernel
+const char *CandidateKernelName(const CandidateKernel kernel);
+
+// Vector kernels write whole registers per row, so both the output table and
+// the cell array they read from carry this much slack past the last cell.
+const int kCandidatePadding = 16;
+
+// Candidate masks for every cell of a board, in row-major order. Assigned
+// cells get an empty mask.
+template <int BoxSize>
+struct CandidateTable {
+    using Geometry = BoardGeometry<BoxSize>;
+
+    alignas(32) std::array<typename Geometry::Mask_t,
+                           Geometry::kTotalBoardSize + kCandidatePadding> masks;
+
+    typename Geometry::Mask_t operator[](const int cell) const { return masks[cell]; }
+};
+
+// Unit mask arrays passed to the kernels need this many readable entries
+// past the last box.
+const int kUnitMaskPadding = 4;
+
+// Computes the candidates of all cells from the cell values and unit masks
+// (rows, then columns, then boxes) using the given kernel. cells must have
+// kCandidatePadding readable bytes past the last cell, and unit_masks
+// kUnitMaskPadding entries past the last box. Asking for a kernel
+// the board or CPU can't use falls back to the scalar one.
+template <int BoxSize>
+void ComputeCandidates(const CandidateKernel kernel, const std::uint8_t *cells,
+                       const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                       CandidateTable<BoxSize> &table);
+
+// Same as above with the kernel picked by DetectCandidateKernel
+template <int BoxSize>
+void ComputeCandidates(const std::uint8_t *cells,
+                       const typename BoardGeometry<BoxSize>::Mask_t *unit_masks,
+                       CandidateTable<BoxSize> &table);
+}  // namespace Sudoku
@@ -0,0 +1,551 @@
+#include "cdcl.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Sudoku {
+
+namespace {
+// Restart intervals grow with the Luby sequence 1 1 2 1 1 2 4 1 1 2 ...
+double Luby(const double base, int index) {
+    int size = 1;
+    int sequence = 0;
+    while (size < index + 1) {
+        ++sequence;
+        size = 2 * size + 1;
+    }
+
+    while (size - 1 != index) {
+        size = (size - 1) >> 1;
+        --sequence;
+        index = index % size;
+    }
+
+    double result = 1.0;
+    for (int i = 0; i < sequence; ++i) {
+        result *= base;
+    }
+    return result;
+}
+
+const int kRestartBase = 100;
+const double kVariableDecay = 0.95;
+const double kClauseDecay = 0.999;
+const double kRescaleLimit = 1e100;
+}  // namespace
+
+const int CdclSolver::kNoClause;
+const std::int8_t CdclSolver::kUndefined;
+const std::int8_t CdclSolver::kTrue;
+const std::int8_t CdclSolver::kFalse;
+
+void CdclSolver::Reset() {
+    ok_ = true;
+    literals_.clear();
+    clauses_.clear();
+    assigns_.clear();
+    levels_.clear();
+    reasons_.clear();
+    phases_.clear();
+    seen_.clear();
+    trail_.clear();
+    trail_limits_.clear();
+    propagated_ = 0;
+    activity_.clear();
+    heap_.clear();
+    heap_index_.clear();
+    variable_increment_ = 1.0;
+    clause_increment_ = 1.0;
+    model_.clear();
+    conflicts_ = 0;
+    decisions_ = 0;
+
+    // the watch lists keep their storage for the next formula
+    for (auto &watch_list : watches_) {
+        watch_list.clear();
+    }
+}
+
+int CdclSolver::NewVariable() {
+    const int variable = VariableCount();
+
+    assigns_.push_back(kUndefined);
+    levels_.push_back(0);
+    reasons_.push_back(kNoClause);
+    phases_.push_back(false);
+    seen_.push_back(false);
+    activity_.push_back(0.0);
+    heap_index_.push_back(-1);
+    if (watches_.size() < assigns_.size() * 2) {
+        watches_.resize(assigns_.size() * 2);
+    }
+
+    HeapInsert(variable);
+    return variable;
+}
+
+bool CdclSolver::AddClause(std::vector<Literal> literals) {
+    if (!ok_) {
+        return false;
+    }
+
+    std::sort(literals.begin(), literals.end());
+    literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < literals.size(); ++i) {
+        // literals of one variable are adjacent after sorting
+        if (Value(literals[i]) == kTrue ||
+            (i + 1 < literals.size() && literals[i + 1] == (literals[i] ^ 1))) {
+            return true;
+        }
+        if (Value(literals[i]) == kUndefined) {
+            literals[kept++] = literals[i];
+        }
+    }
+    literals.resize(kept);
+
+    if (literals.empty()) {
+        ok_ = false;
+        return false;
+    }
+
+    if (literals.size() == 1) {
+        Enqueue(literals[0], kNoClause);
+        ok_ = (Propagate() == kNoClause);
+        return ok_;
+    }
+
+    clauses_.push_back(Clause{static_cast<int>(literals_.size()),
+                              static_cast<int>(literals.size()), false, 0.0});
+    literals_.insert(literals_.end(), literals.begin(), literals.end());
+    Watch(static_cast<int>(clauses_.size()) - 1);
+
+    return true;
+}
+
+void CdclSolver::Enqueue(const Literal literal, const int reason) {
+    const int variable = literal >> 1;
+    assigns_[variable] = (literal & 1) ? kFalse : kTrue;
+    levels_[variable] = DecisionLevel();
+    reasons_[variable] = reason;
+    trail_.push_back(literal);
+}
+
+void CdclSolver::Watch(const int clause) {
+    const Literal *literals = &literals_[clauses_[clause].start];
+    watches_[literals[0]].push_back(Watcher{clause, literals[1]});
+    watches_[literals[1]].push_back(Watcher{clause, literals[0]});
+}
+
+int CdclSolver::Propagate() {
+    int conflict = kNoClause;
+
+    while (propagated_ < trail_.size() && conflict == kNoClause) {
+        const Literal false_literal = trail_[propagated_++] ^ 1;
+        std::vector<Watcher> &watchers = watches_[false_literal];
+
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < watchers.size()) {
+            const Watcher watcher = watchers[i++];
+            if (Value(watcher.blocker) == kTrue) {
+                watchers[j++] = watcher;
+                continue;
+            }
+
+            const Clause &clause = clauses_[watcher.clause];
+            Literal *literals = &literals_[clause.start];
+
+            // keep the false literal in slot 1
+            if (literals[0] == false_literal) {
+                std::swap(literals[0], literals[1]);
+            }
+
+            const Literal first = literals[0];
+            if (first != watcher.blocker && Value(first) == kTrue) {
+                watchers[j++] = Watcher{watcher.clause, first};
+                continue;
+            }
+
+            bool moved = false;
+            for (int k = 2; k < clause.size; ++k) {
+                if (Value(literals[k]) != kFalse) {
+                    std::swap(literals[1], literals[k]);
+                    watches_[literals[1]].push_back(Watcher{watcher.clause, first});
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) {
+                continue;
+            }
+
+            // the clause is unit or conflicting
+            watchers[j++] = Watcher{watcher.clause, first};
+            if (Value(first) == kFalse) {
+                conflict = watcher.clause;
+                while (i < watchers.size()) {
+                    watchers[j++] = watchers[i++];
+                }
+            } else {
+                Enqueue(first, watcher.clause);
+            }
+        }
+        watchers.resize(j);
+    }
+
+    return conflict;
+}
+
+int CdclSolver::Analyze(int conflict) {
+    learnt_.clear();
+    learnt_.push_back(0);
+
+    int path = 0;
+    Literal implied = -1;
+    int index = static_cast<int>(trail_.size()) - 1;
+
+    do {
+        Clause &clause = clauses_[conflict];
+        if (clause.learnt) {
+            BumpClause(clause);
+        }
+
+        // slot 0 of a reason holds the literal it implied
+        for (int j = (implied == -1) ? 0 : 1; j < clause.size; ++j) {
+            const Literal literal = literals_[clause.start + j];
+            const int variable = literal >> 1;
+
+            if (!seen_[variable] && levels_[variable] > 0) {
+                seen_[variable] = true;
+                BumpVariable(variable);
+                if (levels_[variable] >= DecisionLevel()) {
+                    ++path;
+                } else {
+                    learnt_.push_back(literal);
+                }
+            }
+        }
+
+        while (!seen_[trail_[index] >> 1]) {
+            --index;
+        }
+        implied = trail_[index--];
+        conflict = reasons_[implied >> 1];
+        seen_[implied >> 1] = false;
+        --path;
+    } while (path > 0);
+
+    learnt_[0] = implied ^ 1;
+
+    // Drop literals implied by the rest of the clause
+    seen_literals_.assign(learnt_.begin() + 1, learnt_.end());
+    std::size_t kept = 1;
+    for (std::size_t i = 1; i < learnt_.size(); ++i) {
+        const int reason = reasons_[learnt_[i] >> 1];
+        bool redundant = (reason != kNoClause);
+
+        if (redundant) {
+            const Clause &clause = clauses_[reason];
+            for (int j = 1; j < clause.size; ++j) {
+                const int variable = literals_[clause.start + j] >> 1;
+                if (!seen_[variable] && levels_[variable] > 0) {
+                    redundant = false;
+                    break;
+                }
+            }
+        }
+
+        if (!redundant) {
+            learnt_[kept++] = learnt_[i];
+        }
+    }
+    learnt_.resize(kept);
+    for (const Literal literal : seen_literals_) {
+        seen_[literal >> 1] = false;
+    }
+
+    if (learnt_.size() == 1) {
+        return 0;
+    }
+
+    // watch the literal of the highest remaining level next to the asserting one
+    std::size_t highest = 1;
+    for (std::size_t i = 2; i < learnt_.size(); ++i) {
+        if (levels_[learnt_[i] >> 1] > levels_[learnt_[highest] >> 1]) {
+            highest = i;
+        }
+    }
+    std::swap(learnt_[1], learnt_[highest]);
+
+    return levels_[learnt_[1] >> 1];
+}
+
+void CdclSolver::Backtrack(const int level) {
+    if (DecisionLevel() <= level) {
+        return;
+    }
+
+    for (int i = static_cast<int>(trail_.size()) - 1; i >= trail_limits_[level]; --i) {
+        const int variable = trail_[i] >> 1;
+        phases_[variable] = (assigns_[variable] == kTrue);
+        assigns_[variable] = kUndefined;
+        reasons_[variable] = kNoClause;
+        HeapInsert(variable);
+    }
+
+    trail_.resize(trail_limits_[level]);
+    trail_limits_.resize(level);
+    propagated_ = trail_.size();
+}
+
+int CdclSolver::PickBranchVariable() {
+    while (!heap_.empty()) {
+        const int variable = HeapPop();
+        if (assigns_[variable] == kUndefined) {
+            return variable;
+        }
+    }
+
+    return -1;
+}
+
+void CdclSolver::BumpVariable(const int variable) {
+    activity_[variable] += variable_increment_;
+    if (activity_[variable] > kRescaleLimit) {
+        for (auto &activity : activity_) {
+            activity /= kRescaleLimit;
+        }
+        variable_increment_ /= kRescaleLimit;
+    }
+
+    if (heap_index_[variable] >= 0) {
+        HeapUp(heap_index_[variable]);
+    }
+}
+
+void CdclSolver::BumpClause(Clause &clause) {
+    clause.activity += clause_increment_;
+    if (clause.activity > kRescaleLimit) {
+        for (auto &other : clauses_) {
+            other.activity /= kRescaleLimit;
+        }
+        clause_increment_ /= kRescaleLimit;
+    }
+}
+
+void CdclSolver::Simplify(const bool reduce) {
+    std::vector<bool> removed(clauses_.size(), false);
+
+    if (reduce) {
+        std::vector<int> learnts;
+        for (std::size_t i = 0; i < clauses_.size(); ++i) {
+            if (clauses_[i].learnt && clauses_[i].size > 2) {
+                learnts.push_back(static_cast<int>(i));
+            }
+        }
+
+        std::sort(learnts.begin(), learnts.end(), [this](const int a, const int b) {
+            return clauses_[a].activity < clauses_[b].activity;
+        });
+        for (std::size_t i = 0; i < learnts.size() / 2; ++i) {
+            removed[learnts[i]] = true;
+        }
+    }
+
+    // Level 0 facts never need their reasons again
+    for (const Literal literal : trail_) {
+        reasons_[literal >> 1] = kNoClause;
+    }
+
+    std::vector<Literal> literals;
+    literals.reserve(literals_.size());
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < clauses_.size(); ++i) {
+        if (removed[i]) {
+            continue;
+        }
+
+        Clause clause = clauses_[i];
+        const std::size_t start = literals.size();
+        bool satisfied = false;
+        for (int j = 0; j < clause.size && !satisfied; ++j) {
+            const Literal literal = literals_[clause.start + j];
+            if (Value(literal) == kTrue) {
+                satisfied = true;
+            } else if (Value(literal) == kUndefined) {
+                literals.push_back(literal);
+            }
+        }
+
+        if (satisfied) {
+            literals.resize(start);
+            continue;
+        }
+
+        // everything at level 0 is propagated, so two literals remain
+        clause.start = static_cast<int>(start);
+        clause.size = static_cast<int>(literals.size() - start);
+        clauses_[kept++] = clause;
+    }
+    clauses_.resize(kept);
+    literals_.swap(literals);
+
+    for (auto &watch_list : watches_) {
+        watch_list.clear();
+    }
+    for (std::size_t i = 0; i < clauses_.size(); ++i) {
+        Watch(static_cast<int>(i));
+    }
+}
+
+CdclSolver::Result CdclSolver::Solve(const std::uint64_t conflict_limit) {
+    model_.clear();
+    if (!ok_ || Propagate() != kNoClause) {
+        ok_ = false;
+        return Result::kUnsatisfiable;
+    }
+
+    const std::uint64_t first_conflict = conflicts_;
+    std::size_t learnt_count = 0;
+    std::size_t max_learnts = clauses_.size() / 3 + 1000;
+    std::size_t simplified_trail = 0;
+    int restarts = 0;
+    std::uint64_t restart_conflicts = 0;
+    double restart_limit = kRestartBase * Luby(2.0, restarts);
+
+    for (;;) {
+        const int conflict = Propagate();
+
+        if (conflict != kNoClause) {
+            ++conflicts_;
+            ++restart_conflicts;
+            if (DecisionLevel() == 0) {
+                ok_ = false;
+                return Result::kUnsatisfiable;
+            }
+
+            Backtrack(Analyze(conflict));
+            if (learnt_.size() == 1) {
+                Enqueue(learnt_[0], kNoClause);
+            } else {
+                clauses_.push_back(Clause{static_cast<int>(literals_.size()),
+                                          static_cast<int>(learnt_.size()), true, 0.0});
+                literals_.insert(literals_.end(), learnt_.begin(), learnt_.end());
+
+                const int clause = static_cast<int>(clauses_.size()) - 1;
+                Watch(clause);
+                BumpClause(clauses_[clause]);
+                Enqueue(learnt_[0], clause);
+                ++learnt_count;
+            }
+
+            variable_increment_ /= kVariableDecay;
+            clause_increment_ /= kClauseDecay;
+
+            if (conflict_limit != 0 && conflicts_ - first_conflict >= conflict_limit) {
+                Backtrack(0);
+                return Result::kUnknown;
+            }
+            continue;
+        }
+
+        if (restart_conflicts >= restart_limit) {
+            Backtrack(0);
+            restart_conflicts = 0;
+            restart_limit = kRestartBase * Luby(2.0, ++restarts);
+
+            const bool reduce = learnt_count >= max_learnts;
+            if (reduce || trail_.size() > simplified_trail) {
+                Simplify(reduce);
+                simplified_trail = trail_.size();
+                learnt_count = 0;
+                for (auto &clause : clauses_) {
+                    learnt_count += clause.learnt ? 1 : 0;
+                }
+            }
+            if (reduce) {
+                max_learnts += max_learnts / 10;
+            }
+            continue;
+        }
+
+        const int variable = PickBranchVariable();
+        if (variable < 0) {
+            model_.resize(assigns_.size());
+            for (std::size_t i = 0; i < assigns_.size(); ++i) {
+                model_[i] = (assigns_[i] == kTrue);
+            }
+            Backtrack(0);
+            return Result::kSatisfiable;
+        }
+
+        ++decisions_;
+        trail_limits_.push_back(static_cast<int>(trail_.size()));
+        Enqueue(phases_[variable] ? Positive(variable) : Negative(variable), kNoClause);
+    }
+}
+
+void CdclSolver::HeapInsert(const int variable) {
+    if (heap_index_[variable] >= 0) {
+        return;
+    }
+
+    heap_index_[variable] = static_cast<int>(heap_.size());
+    heap_.push_back(variable);
+    HeapUp(heap_index_[variable]);
+}
+
+int CdclSolver::HeapPop() {
+    const int top = heap_[0];
+    heap_index_[top] = -1;
+
+    const int last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heap_index_[last] = 0;
+        HeapDown(0);
+    }
+
+    return top;
+}
+
+void CdclSolver::HeapUp(int position) {
+    const int variable = heap_[position];
+    while (position > 0) {
+        const int parent = (position - 1) / 2;
+        if (activity_[heap_[parent]] >= activity_[variable]) {
+            break;
+        }
+        heap_[position] = heap_[parent];
+        heap_index_[heap_[position]] = position;
+        position = parent;
+    }
+    heap_[position] = variable;
+    heap_index_[variable] = position;
+}
+
+void CdclSolver::HeapDown(int position) {
+    const int variable = heap_[position];
+    const int size = static_cast<int>(heap_.size());
+    for (;;) {
+        int child = 2 * position + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && activity_[heap_[child + 1]] > activity_[heap_[child]]) {
+            ++child;
+        }
+        if (activity_[heap_[child]] <= activity_[variable]) {
+            break;
+        }
+        heap_[position] = heap_[child];
+        heap_index_[heap_[position]] = position;
+        position = child;
+    }
+    heap_[position] = variable;
+    heap_index_[variable] = position;
+}
+}  // namespace Sudoku
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Sudoku {
+
+// Small conflict driven clause learning SAT solver: two watched literals with
+// blockers, first UIP clause learning, VSIDS branching with phase saving, Luby
+// restarts, and learnt clause reduction at restarts.
+//
+// Variables are numbered from 0. A literal is 2 * variable for the positive
+// literal and 2 * variable + 1 for its negation. Clauses may only be added
+// before Solve, or after Reset.
+class CdclSolver {
+   public:
+    using Literal = int;
+
+    enum class Result { kSatisfiable, kUnsatisfiable, kUnknown };
+
+    static Literal Positive(const int variable) { return 2 * variable; }
+    static Literal Negative(const int variable) { return 2 * variable + 1; }
+
+    // Forgets all variables and clauses, keeping allocated storage
+    void Reset();
+
+    // Adds a variable and returns its number
+    int NewVariable();
+
+    int VariableCount() const { return static_cast<int>(assigns_.size()); }
+
+    // Adds a clause (the disjunction of the literals). Returns false if the
+    // formula is now known to be unsatisfiable.
+    bool AddClause(std::vector<Literal> literals);
+
+    // Searches for a satisfying assignment. A non zero conflict_limit gives up
+    // with kUnknown after that many conflicts.
+    Result Solve(const std::uint64_t conflict_limit = 0);
+
+    // Value of the variable in the last satisfying assignment
+    bool ModelValue(const int variable) const { return model_[variable]; }
+
+    std::uint64_t Conflicts() const { return conflicts_; }
+    std::uint64_t Decisions() const { return decisions_; }
+
+   private:
+    static const int kNoClause = -1;
+
+    struct Clause {
+        int start;
+        int size;
+        bool learnt;
+        double activity;
+    };
+
+    struct Watcher {
+        int clause;
+        Literal blocker;
+    };
+
+    // Truth values of assigns_: unassigned, true, false
+    static const std::int8_t kUndefined = 0;
+    static const std::int8_t kTrue = 1;
+    static const std::int8_t kFalse = -1;
+
+    bool ok_ = true;
+    std::vector<Literal> literals_;
+    std::vector<Clause> clauses_;
+    std::vector<std::vector<Watcher>> watches_;
+
+    std::vector<std::int8_t> assigns_;
+    std::vector<int> levels_;
+    std::vector<int> reasons_;
+    std::vector<bool> phases_;
+    std::vector<bool> seen_;
+    std::vector<Literal> trail_;
+    std::vector<int> trail_limits_;
+    std::size_t propagated_ = 0;
+
+    // VSIDS: variable activities in a binary max heap
+    std::vector<double> activity_;
+    std::vector<int> heap_;
+    std::vector<int> heap_index_;
+    double variable_increment_ = 1.0;
+    double clause_increment_ = 1.0;
+
+    std::vector<bool> model_;
+    std::vector<Literal> learnt_;
+    std::vector<Literal> seen_literals_;
+    std::uint64_t conflicts_ = 0;
+    std::uint64_t decisions_ = 0;
+
+    std::int8_t Value(const Literal literal) const {
+        const std::int8_t value = assigns_[literal >> 1];
+        return (literal & 1) ? static_cast<std::int8_t>(-value) : value;
+    }
+
+    int DecisionLevel() const { return static_cast<int>(trail_limits_.size()); }
+
+    void Enqueue(const Literal literal, const int reason);
+    void Watch(const int clause);
+    int Propagate();
+    int Analyze(int conflict);
+    void Backtrack(const int level);
+    int PickBranchVariable();
+    void BumpVariable(const int variable);
+    void BumpClause(Clause &clause);
+
+    // Drops satisfied clauses, false literals and the less active half of the
+    // learnt clauses, then rebuilds the watch lists. Only valid at level 0.
+    void Simplify(const bool reduce);
+
+    void HeapInsert(const int variable);
+    int HeapPop();
+    void HeapUp(int position);
+    void HeapDown(int position);
+};
+}  // namespace Sudoku
@@ -0,0 +1,68 @@
+#include "engine.h"
+
+#include <chrono>
+
+#include "band_solver.h"
+#include "lockstep_solver.h"
+#include "logic_solver.h"
+#include "metrics.h"
+#include "sat_solver.h"
+#include "solver.h"
+
+namespace Sudoku {
+
+template <int BoxSize>
+std::vector<bool> BasicEngine<BoxSize>::SolvePuzzles(std::vector<BasicPuzzle<BoxSize>> &puzzles) {
+    std::vector<bool> result_vector;
+    result_vector.reserve(puzzles.size());
+
+    for (auto &puzzle : puzzles) {
+        result_vector.push_back(SolveRecorded(puzzle));
+    }
+
+    return result_vector;
+}
+
+template <int BoxSize>
+bool BasicEngine<BoxSize>::SolveRecorded(BasicPuzzle<BoxSize> &puzzle) {
+    if (metrics_ == nullptr) {
+        return SolvePuzzle(puzzle);
+    }
+
+    // two clock reads per puzzle, against solves that take microseconds
+    auto start = std::chrono::steady_clock::now();
+    bool solved = SolvePuzzle(puzzle);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    RecordSolve(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), solved);
+    return solved;
+}
+
+template <int BoxSize>
+void BasicEngine<BoxSize>::RecordSolve(const std::uint64_t nanoseconds, const bool solved) {
+    if (metrics_ != nullptr) {
+        metrics_->Record(metrics_shard_, nanoseconds, LastNodes(), solved, budget_exhausted_);
+    }
+}
+
+std::unique_ptr<Engine> MakeEngine(const std::string &name) {
+    std::unique_ptr<Engine> engine;
+    if (name == "backtrack") {
+        engine.reset(new Solver());
+    } else if (name == "band") {
+        engine.reset(new BandSolver());
+    } else if (name == "sat") {
+        engine.reset(new SatSolver());
+    } else if (name == "logic") {
+        engine.reset(new LogicSolver());
+    } else if (name == "lockstep") {
+        engine.reset(new LockstepSolver());
+    }
+
+    return engine;
+}
+
+template class BasicEngine<3>;
+template class BasicEngine<4>;
+template class BasicEngine<5>;
+}  // namespace Sudoku
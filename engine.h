@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "puzzle.h"
+
+namespace Sudoku {
+
+class EngineMetrics;
+
+// Common interface of the solving engines, so callers (batches, the
+// generator, benchmarks) can swap one engine for another. Every engine takes
+// a puzzle, fills it in place if it can be solved, and reports whether it was.
+//
+// Engines keep per-search scratch state, so an engine must only be used by one
+// thread at a time.
+template <int BoxSize>
+class BasicEngine {
+   public:
+    virtual ~BasicEngine() = default;
+
+    // Short name of the engine, used in reports and on the command line
+    virtual const char *Name() const = 0;
+
+    // Attempts to solve a single puzzle, and returns true if it was able to be
+    // solved.
+    virtual bool SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) = 0;
+
+    // Given a vector of puzzles to solve, returns a vector of boolean values
+    // representing which puzzles were solved. Each puzzle goes through
+    // SolveRecorded, unless the engine solves puzzles together and overrides
+    // this.
+    virtual std::vector<bool> SolvePuzzles(std::vector<BasicPuzzle<BoxSize>> &puzzles);
+
+    // SolvePuzzle, also recording the outcome, time taken and LastNodes in
+    // the attached metrics
+    bool SolveRecorded(BasicPuzzle<BoxSize> &puzzle);
+
+    // Records puzzles solved through SolveRecorded into the given shard of
+    // metrics, which must outlive the engine, or stops recording if metrics
+    // is null. Shards aren't shared between threads, so give each engine
+    // solving concurrently its own.
+    void AttachMetrics(EngineMetrics *metrics, const unsigned shard) {
+        metrics_ = metrics;
+        metrics_shard_ = shard;
+    }
+
+    // Caps the search spent on each puzzle, counted in LastNodes; 0 means no
+    // cap. A puzzle that runs out is reported unsolved and left as it was,
+    // and LastBudgetExhausted() returns true.
+    void SetNodeLimit(const std::uint64_t limit) { node_limit_ = limit; }
+
+    // Makes SolvePuzzle return the lexicographically first solution (reading
+    // the cells row-major, smallest values first), so a puzzle with several
+    // solutions always gets the same one, whichever engine instance or thread
+    // solves it. Returns false, changing nothing, for engines that can't.
+    virtual bool SetLexicographic(const bool lexicographic) { return !lexicographic; }
+
+    // Search nodes the last puzzle took. What counts as a node depends on the
+    // engine: branches for "backtrack", guesses for "band" and conflicts for
+    // "sat". Engines that never search report 0.
+    virtual std::uint64_t LastNodes() const { return 0; }
+
+    // Whether the last puzzle was given up at the node limit
+    bool LastBudgetExhausted() const { return budget_exhausted_; }
+
+   protected:
+    std::uint64_t node_limit_ = 0;
+    bool budget_exhausted_ = false;
+
+    // Records a puzzle solved without going through SolveRecorded in the
+    // attached metrics, if any
+    void RecordSolve(const std::uint64_t nanoseconds, const bool solved);
+
+    bool RecordingMetrics() const { return metrics_ != nullptr; }
+
+   private:
+    EngineMetrics *metrics_ = nullptr;
+    unsigned metrics_shard_ = 0;
+};
+
+using Engine = BasicEngine<3>;
+using Engine16 = BasicEngine<4>;
+using Engine25 = BasicEngine<5>;
+
+// Creates a 9x9 engine from its Name() ("backtrack", "band", "sat", "logic"
+// or "lockstep"). Returns null for names it doesn't know.
+std::unique_ptr<Engine> MakeEngine(const std::string &name);
+
+// Instantiated in engine.cpp
+extern template class BasicEngine<3>;
+extern template class BasicEngine<4>;
+extern template class BasicEngine<5>;
+}  // namespace Sudoku
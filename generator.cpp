@@ -1,12 +1,155 @@
 #include "generator.h"
 
+#include "band_solver.h"
+#include "grid_sampler.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 
 namespace Sudoku {
 
+namespace {
+// splitmix64 step, used to derive independent seeds
+std::uint64_t MixSeed(const std::uint64_t seed, const std::uint64_t value) {
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (value + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Everything one generating thread needs, reused from puzzle to puzzle
+class PuzzleMaker {
+   public:
+    // Makes the index'th puzzle for the options, returning false if no
+    // attempt landed in the difficulty range
+    bool Make(const std::size_t index, const GenerationOptions& options, Puzzle& puzzle) {
+        for (int attempt = 0; attempt < options.max_attempts; ++attempt) {
+            const std::uint64_t seed = MixSeed(MixSeed(options.seed, index), attempt);
+            sampler_.Seed(seed);
+
+            puzzle = RemoveClues(sampler_.SampleFresh(), MixSeed(seed, 0));
+            const double difficulty = rater_.Rate(puzzle).difficulty;
+            if (difficulty >= options.min_difficulty && difficulty <= options.max_difficulty) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+   private:
+    BandSolver counter_;
+    LogicSolver rater_;
+    GridSampler sampler_;
+    std::array<int, kTotalBoardSize> order_;
+
+    // Tries every clue once in an order shuffled from seed, dropping it if
+    // the solution stays unique. A clue needed once is needed for good, so the
+    // result is minimal.
+    Puzzle RemoveClues(Puzzle puzzle, const std::uint64_t seed) {
+        // Fisher-Yates on splitmix64 draws rather than std::shuffle, whose
+        // algorithm is up to the standard library, so a seed gives the same
+        // puzzles on every platform
+        std::iota(order_.begin(), order_.end(), 0);
+        for (int i = kTotalBoardSize - 1; i > 0; --i) {
+            const std::uint64_t draw = MixSeed(seed, static_cast<std::uint64_t>(i)) >> 11;
+            std::swap(order_[i], order_[draw % static_cast<std::uint64_t>(i + 1)]);
+        }
+
+        for (const int cell : order_) {
+            const int value = puzzle.GetCell(cell);
+            puzzle.Unassign(cell);
+            if (counter_.CountSolutions(puzzle, 2) != 1) {
+                puzzle.Assign(cell, value);
+            }
+        }
+
+        return puzzle;
+    }
+};
+}  // namespace
+
+std::vector<Puzzle> Generator::GeneratePuzzles(const std::size_t count,
+                                               const GenerationOptions& options) {
+    std::vector<Puzzle> puzzles(count);
+    const unsigned thread_count =
+        std::max(1u, std::min<unsigned>(options.threads, static_cast<unsigned>(count)));
+
+    // Each thread takes every thread_count'th slot
+    std::vector<std::exception_ptr> errors(thread_count);
+    auto work = [&](const unsigned first) {
+        try {
+            PuzzleMaker maker;
+            for (std::size_t i = first; i < count; i += thread_count) {
+                if (!maker.Make(i, options, puzzles[i])) {
+                    throw std::runtime_error(
+                        "Could not generate a puzzle in the requested difficulty range");
+                }
+            }
+        } catch (...) {
+            errors[first] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < thread_count; ++t) {
+        threads.emplace_back(work, t);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    return puzzles;
+}
+
+Puzzle Generator::GeneratePuzzle(const std::size_t index, const GenerationOptions& options) {
+    PuzzleMaker maker;
+    Puzzle puzzle;
+    if (!maker.Make(index, options, puzzle)) {
+        throw std::runtime_error("Could not generate a puzzle in the requested difficulty range");
+    }
+
+    return puzzle;
+}
+
+std::vector<Puzzle> Generator::ReadPuzzles(std::istream& input) {
+    std::vector<Puzzle> puzzles;
+    std::string line;
+
+    for (int line_number = 1; std::getline(input, line); ++line_number) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        try {
+            puzzles.emplace_back(line);
+        } catch (const std::invalid_argument& e) {
+            throw std::invalid_argument("Line " + std::to_string(line_number) + ": " + e.what());
+        }
+    }
+
+    return puzzles;
+}
+
 std::vector<Puzzle> Generator::GetPuzzlesFromUser() {
     std::vector<Puzzle> puzzles;
     std::string puzzle_line;
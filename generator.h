@@ -1,7 +1,9 @@
 #pragma once
 
+#include "logic_solver.h"
 #include "puzzle.h"
 
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <vector>
@@ -10,12 +12,43 @@ namespace Sudoku {
 
 const std::string kSpfHeader = "#spf1.0";
 
+// Settings for Generator::GeneratePuzzles
+struct GenerationOptions {
+    // Puzzle i is built from a seed derived only from this seed and i, so a
+    // seed always yields the same puzzles whatever the thread count or
+    // platform.
+    std::uint64_t seed = 0;
+
+    unsigned threads = 1;
+
+    // Only keep puzzles whose LogicSolver difficulty is in this range
+    double min_difficulty = 0.0;
+    double max_difficulty = kGuessingDifficulty;
+
+    // Fresh puzzles tried per slot before giving up on the difficulty range
+    int max_attempts = 1000;
+};
+
 class Generator {
    public:
+    // Generates count minimal puzzles (removing any clue gives more than one
+    // solution) with unique solutions. Throws std::runtime_error if some slot
+    // found no puzzle in the difficulty range within max_attempts.
+    std::vector<Puzzle> GeneratePuzzles(const std::size_t count,
+                                        const GenerationOptions& options);
+
+    // Generates the index'th puzzle GeneratePuzzles would for these options
+    static Puzzle GeneratePuzzle(const std::size_t index, const GenerationOptions& options);
+
     // Fetches a list of puzzles from the source specified by the user
     // This could be either via user input on commandline, or from a file.
     std::vector<Puzzle> GetPuzzlesFromUser();
 
+    // Reads every puzzle of an SPF stream, one per line, skipping blank lines
+    // and '#' lines such as the header. Throws std::invalid_argument naming
+    // the first line that isn't a puzzle.
+    static std::vector<Puzzle> ReadPuzzles(std::istream& input);
+
     /**
      * Following methods were made public for the purposes of testing-- originally private
      */
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace Sudoku {
+
+namespace detail {
+// Index arithmetic used to build the lookup tables below. These only ever run
+// at compile time.
+template <int BoxSize>
+struct CellMath {
+    static constexpr int kBoardSize = BoxSize * BoxSize;
+
+    static constexpr int RowOf(const int cell) { return cell / kBoardSize; }
+
+    static constexpr int ColumnOf(const int cell) { return cell % kBoardSize; }
+
+    static constexpr int BoxOf(const int cell) {
+        return (RowOf(cell) / BoxSize) * BoxSize + ColumnOf(cell) / BoxSize;
+    }
+
+    // Returns the index'th peer of the cell. Peers are listed as the other
+    // cells of the row, then the other cells of the column, then the cells of
+    // the box that share neither the row nor the column.
+    static constexpr int PeerOf(const int cell, const int index) {
+        const int row = RowOf(cell);
+        const int column = ColumnOf(cell);
+
+        if (index < kBoardSize - 1) {
+            return row * kBoardSize + (index < column ? index : index + 1);
+        }
+
+        if (index < 2 * (kBoardSize - 1)) {
+            const int i = index - (kBoardSize - 1);
+            return (i < row ? i : i + 1) * kBoardSize + column;
+        }
+
+        const int i = index - 2 * (kBoardSize - 1);
+        const int box_row = i / (BoxSize - 1);
+        const int box_column = i % (BoxSize - 1);
+        const int row_in_box = row % BoxSize;
+        const int column_in_box = column % BoxSize;
+
+        return ((row - row_in_box) + (box_row < row_in_box ? box_row : box_row + 1)) * kBoardSize +
+               (column - column_in_box) +
+               (box_column < column_in_box ? box_column : box_column + 1);
+    }
+
+    // Returns the index'th cell of a unit. Units 0..N-1 are rows, N..2N-1 are
+    // columns and 2N..3N-1 are boxes.
+    static constexpr int UnitCell(const int unit, const int index) {
+        if (unit < kBoardSize) {
+            return unit * kBoardSize + index;
+        }
+
+        if (unit < 2 * kBoardSize) {
+            return index * kBoardSize + (unit - kBoardSize);
+        }
+
+        const int box = unit - 2 * kBoardSize;
+        return ((box / BoxSize) * BoxSize + index / BoxSize) * kBoardSize +
+               (box % BoxSize) * BoxSize + index % BoxSize;
+    }
+};
+
+template <typename T, int BoxSize, std::size_t... Cells>
+constexpr std::array<T, sizeof...(Cells)> MakeRowTable(std::index_sequence<Cells...>) {
+    return {{static_cast<T>(CellMath<BoxSize>::RowOf(Cells))...}};
+}
+
+template <typename T, int BoxSize, std::size_t... Cells>
+constexpr std::array<T, sizeof...(Cells)> MakeColumnTable(std::index_sequence<Cells...>) {
+    return {{static_cast<T>(CellMath<BoxSize>::ColumnOf(Cells))...}};
+}
+
+template <typename T, int BoxSize, std::size_t... Cells>
+constexpr std::array<T, sizeof...(Cells)> MakeBoxTable(std::index_sequence<Cells...>) {
+    return {{static_cast<T>(CellMath<BoxSize>::BoxOf(Cells))...}};
+}
+
+template <typename T, int BoxSize, std::size_t... Peers>
+constexpr std::array<T, sizeof...(Peers)> MakePeerList(const int cell,
+                                                       std::index_sequence<Peers...>) {
+    return {{static_cast<T>(CellMath<BoxSize>::PeerOf(cell, Peers))...}};
+}
+
+template <typename T, int BoxSize, std::size_t PeerCount, std::size_t... Cells>
+constexpr std::array<std::array<T, PeerCount>, sizeof...(Cells)> MakePeerTable(
+    std::index_sequence<Cells...>) {
+    return {{MakePeerList<T, BoxSize>(Cells, std::make_index_sequence<PeerCount>{})...}};
+}
+
+template <typename T, int BoxSize, std::size_t... Indices>
+constexpr std::array<T, sizeof...(Indices)> MakeUnitList(const int unit,
+                                                         std::index_sequence<Indices...>) {
+    return {{static_cast<T>(CellMath<BoxSize>::UnitCell(unit, Indices))...}};
+}
+
+template <typename T, int BoxSize, std::size_t UnitSize, std::size_t... Units>
+constexpr std::array<std::array<T, UnitSize>, sizeof...(Units)> MakeUnitTable(
+    std::index_sequence<Units...>) {
+    return {{MakeUnitList<T, BoxSize>(Units, std::make_index_sequence<UnitSize>{})...}};
+}
+}  // namespace detail
+
+// Compile-time description of a board whose boxes are BoxSize x BoxSize.
+// Everything that depends on the board dimensions hangs off of this, so a
+// single instantiation (eg BoardGeometry<3>) fully describes a board.
+//
+// Cells are numbered row-major from 0 to kTotalBoardSize - 1. The tables give
+// each cell's row, column and box, its peers (every other cell sharing a unit
+// with it), and the cells of every unit, so engines never need to divide or
+// build temporary rows and columns.
+template <int BoxSize>
+struct BoardGeometry {
+    static_assert(BoxSize >= 2 && BoxSize <= 5, "Supported box sizes are 2 through 5");
+
+    static constexpr int kBoxSize = BoxSize;
+    static constexpr int kBoardSize = BoxSize * BoxSize;
+    static constexpr int kTotalBoardSize = kBoardSize * kBoardSize;
+
+    // Number of peers of each cell (20 on a 9x9 board)
+    static constexpr int kPeerCount = 2 * (kBoardSize - 1) + (BoxSize - 1) * (BoxSize - 1);
+
+    // Rows, then columns, then boxes
+    static constexpr int kUnitCount = 3 * kBoardSize;
+
+    // Candidate masks use bit (value - 1) for each value, so the narrowest
+    // unsigned type holding kBoardSize bits is used.
+    using Mask_t =
+        typename std::conditional<(kBoardSize <= 16), std::uint16_t, std::uint32_t>::type;
+
+    // Smallest type able to index every cell of the board
+    using Cell_t =
+        typename std::conditional<(kTotalBoardSize <= 256), std::uint8_t, std::uint16_t>::type;
+
+    static constexpr Mask_t kAllValues = static_cast<Mask_t>((1ull << kBoardSize) - 1);
+
+    static constexpr std::array<std::uint8_t, kTotalBoardSize> kRowOf =
+        detail::MakeRowTable<std::uint8_t, BoxSize>(std::make_index_sequence<kTotalBoardSize>{});
+
+    static constexpr std::array<std::uint8_t, kTotalBoardSize> kColumnOf =
+        detail::MakeColumnTable<std::uint8_t, BoxSize>(
+            std::make_index_sequence<kTotalBoardSize>{});
+
+    static constexpr std::array<std::uint8_t, kTotalBoardSize> kBoxOf =
+        detail::MakeBoxTable<std::uint8_t, BoxSize>(std::make_index_sequence<kTotalBoardSize>{});
+
+    static constexpr std::array<std::array<Cell_t, kPeerCount>, kTotalBoardSize> kPeers =
+        detail::MakePeerTable<Cell_t, BoxSize, kPeerCount>(
+            std::make_index_sequence<kTotalBoardSize>{});
+
+    static constexpr std::array<std::array<Cell_t, kBoardSize>, kUnitCount> kUnits =
+        detail::MakeUnitTable<Cell_t, BoxSize, kBoardSize>(
+            std::make_index_sequence<kUnitCount>{});
+
+    // Bit for a value in a candidate mask
+    static constexpr Mask_t ValueBit(const int value) {
+        return static_cast<Mask_t>(Mask_t{1} << (value - 1));
+    }
+};
+
+template <int BoxSize>
+constexpr int BoardGeometry<BoxSize>::kBoxSize;
+template <int BoxSize>
+constexpr int BoardGeometry<BoxSize>::kBoardSize;
+template <int BoxSize>
+constexpr int BoardGeometry<BoxSize>::kTotalBoardSize;
+template <int BoxSize>
+constexpr int BoardGeometry<BoxSize>::kPeerCount;
+template <int BoxSize>
+constexpr int BoardGeometry<BoxSize>::kUnitCount;
+template <int BoxSize>
+constexpr typename BoardGeometry<BoxSize>::Mask_t BoardGeometry<BoxSize>::kAllValues;
+template <int BoxSize>
+constexpr std::array<std::uint8_t, BoardGeometry<BoxSize>::kTotalBoardSize>
+    BoardGeometry<BoxSize>::kRowOf;
+template <int BoxSize>
+constexpr std::array<std::uint8_t, BoardGeometry<BoxSize>::kTotalBoardSize>
+    BoardGeometry<BoxSize>::kColumnOf;
+template <int BoxSize>
+constexpr std::array<std::uint8_t, BoardGeometry<BoxSize>::kTotalBoardSize>
+    BoardGeometry<BoxSize>::kBoxOf;
+template <int BoxSize>
+constexpr std::array<std::array<typename BoardGeometry<BoxSize>::Cell_t,
+                                BoardGeometry<BoxSize>::kPeerCount>,
+                     BoardGeometry<BoxSize>::kTotalBoardSize>
+    BoardGeometry<BoxSize>::kPeers;
+template <int BoxSize>
+constexpr std::array<std::array<typename BoardGeometry<BoxSize>::Cell_t,
+                                BoardGeometry<BoxSize>::kBoardSize>,
+                     BoardGeometry<BoxSize>::kUnitCount>
+    BoardGeometry<BoxSize>::kUnits;
+}  // namespace Sudoku
@@ -0,0 +1,203 @@
+#include "grid_sampler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace Sudoku {
+
+namespace {
+using Geometry = BoardGeometry<kBoardSquareSize>;
+using Mask_t = Geometry::Mask_t;
+}  // namespace
+
+const int GridSampler::kDefaultPoolSize;
+const int GridSampler::kDefaultRefreshInterval;
+
+GridSampler::GridSampler(const std::uint64_t seed, const int pool_size,
+                         const int refresh_interval)
+    : pool_size_(pool_size < 1 ? 1 : pool_size),
+      refresh_interval_(refresh_interval < 1 ? 1 : refresh_interval) {
+    Seed(seed);
+}
+
+void GridSampler::Seed(const std::uint64_t seed) {
+    state_ = seed;
+    pool_.clear();
+    until_refresh_ = 0;
+}
+
+std::uint64_t GridSampler::Next() {
+    // splitmix64
+    std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+int GridSampler::Below(const int bound) {
+    // the high bits are the best mixed; bias is below 2^-50 for our bounds
+    return static_cast<int>((Next() >> 11) % static_cast<std::uint64_t>(bound));
+}
+
+template <typename T, std::size_t N>
+void GridSampler::Shuffle(std::array<T, N> &values) {
+    for (int i = static_cast<int>(N) - 1; i > 0; --i) {
+        std::swap(values[i], values[Below(i + 1)]);
+    }
+}
+
+void GridSampler::Search(Grid &grid) {
+    const int kBoardSize = Geometry::kBoardSize;
+    const int kTotal = Geometry::kTotalBoardSize;
+
+    std::array<Mask_t, Geometry::kUnitCount> used{};
+    std::array<int, kTotal> order;
+    std::array<Mask_t, kTotal> remaining;
+    grid.fill(kUnassigned);
+
+    auto free_values = [&](const int cell) {
+        return static_cast<Mask_t>(Geometry::kAllValues &
+                                   ~(used[Geometry::kRowOf[cell]] |
+                                     used[kBoardSize + Geometry::kColumnOf[cell]] |
+                                     used[2 * kBoardSize + Geometry::kBoxOf[cell]]));
+    };
+    auto set = [&](const int cell, const int value) {
+        const Mask_t bit = Geometry::ValueBit(value);
+        used[Geometry::kRowOf[cell]] ^= bit;
+        used[kBoardSize + Geometry::kColumnOf[cell]] ^= bit;
+        used[2 * kBoardSize + Geometry::kBoxOf[cell]] ^= bit;
+    };
+
+    // depth first, always on the open cell with the fewest values left,
+    // taking values in random order
+    int depth = 0;
+    bool advance = true;
+    while (depth < kTotal) {
+        if (advance) {
+            int best = -1;
+            int best_count = kBoardSize + 1;
+            for (int cell = 0; cell < kTotal && best_count > 1; ++cell) {
+                if (grid[cell] == kUnassigned) {
+                    const int count = __builtin_popcount(free_values(cell));
+                    if (count < best_count) {
+                        best = cell;
+                        best_count = count;
+                    }
+                }
+            }
+            order[depth] = best;
+            remaining[depth] = free_values(best);
+        }
+
+        const int cell = order[depth];
+        if (grid[cell] != kUnassigned) {
+            set(cell, grid[cell]);
+            grid[cell] = kUnassigned;
+        }
+
+        const Mask_t options = remaining[depth];
+        if (options == 0) {
+            --depth;
+            advance = false;
+            continue;
+        }
+
+        int pick = Below(__builtin_popcount(options));
+        Mask_t bits = options;
+        while (pick-- > 0) {
+            bits &= bits - 1;
+        }
+        const Mask_t bit = bits & static_cast<Mask_t>(-bits);
+
+        remaining[depth] = options & static_cast<Mask_t>(~bit);
+        grid[cell] = static_cast<std::uint8_t>(__builtin_ctz(bit) + 1);
+        set(cell, grid[cell]);
+        ++depth;
+        advance = true;
+    }
+}
+
+void GridSampler::Transform(const Grid &source, Grid &grid) {
+    const int kBoxSize = Geometry::kBoxSize;
+    const int kBoardSize = Geometry::kBoardSize;
+
+    // digits[value] is the value's new label; kUnassigned never occurs
+    std::array<std::uint8_t, kBoardSize> labels;
+    std::iota(labels.begin(), labels.end(), 1);
+    Shuffle(labels);
+
+    std::array<std::uint8_t, kBoardSize + 1> digits;
+    digits[kUnassigned] = kUnassigned;
+    std::copy(labels.begin(), labels.end(), digits.begin() + 1);
+
+    // rows[r] and columns[c] are the source line the result line comes from
+    std::array<int, kBoardSize> lines[2];
+    for (auto &line : lines) {
+        std::array<int, kBoxSize> groups;
+        std::iota(groups.begin(), groups.end(), 0);
+        Shuffle(groups);
+
+        for (int group = 0; group < kBoxSize; ++group) {
+            std::array<int, kBoxSize> within;
+            std::iota(within.begin(), within.end(), 0);
+            Shuffle(within);
+            for (int i = 0; i < kBoxSize; ++i) {
+                line[group * kBoxSize + i] = groups[group] * kBoxSize + within[i];
+            }
+        }
+    }
+
+    const bool transpose = Below(2) == 1;
+    for (int row = 0; row < kBoardSize; ++row) {
+        for (int column = 0; column < kBoardSize; ++column) {
+            const int from = transpose ? lines[1][column] * kBoardSize + lines[0][row]
+                                       : lines[0][row] * kBoardSize + lines[1][column];
+            grid[row * kBoardSize + column] = digits[source[from]];
+        }
+    }
+}
+
+void GridSampler::Sample(Grid &grid) {
+    if (static_cast<int>(pool_.size()) < pool_size_) {
+        pool_.emplace_back();
+        Search(pool_.back());
+        Transform(pool_.back(), grid);
+        return;
+    }
+
+    if (--until_refresh_ < 0) {
+        Search(pool_[Below(pool_size_)]);
+        until_refresh_ = refresh_interval_;
+    }
+
+    Transform(pool_[Below(pool_size_)], grid);
+}
+
+Puzzle GridSampler::Sample() {
+    Grid grid;
+    Sample(grid);
+    return ToPuzzle(grid);
+}
+
+void GridSampler::SampleFresh(Grid &grid) {
+    Grid searched;
+    Search(searched);
+    Transform(searched, grid);
+}
+
+Puzzle GridSampler::SampleFresh() {
+    Grid grid;
+    SampleFresh(grid);
+    return ToPuzzle(grid);
+}
+
+Puzzle GridSampler::ToPuzzle(const Grid &grid) {
+    Puzzle puzzle;
+    for (int cell = 0; cell < kTotalBoardSize; ++cell) {
+        puzzle.Assign(cell, grid[cell]);
+    }
+
+    return puzzle;
+}
+}  // namespace Sudoku
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "puzzle.h"
+
+namespace Sudoku {
+
+// Produces random completed 9x9 grids, the first stage of puzzle generation.
+//
+// Fresh grids come from a depth first fill on row, column and box masks that
+// tries candidates in random order. Every grid handed out is then put through
+// a random symmetry of the board: relabelling the digits, permuting bands and
+// stacks, rows within bands and columns within stacks, and transposing. These
+// map valid grids to valid grids and spread each fresh grid evenly over its
+// (usually 1.2 trillion strong) equivalence class.
+//
+// Sample() transforms grids from a small pool of fresh grids, replacing one
+// pool entry every refresh_interval samples, which is much faster than
+// searching each time. Everything is driven by one seeded generator, so a
+// seed always reproduces the same sequence of grids, on any platform.
+class GridSampler {
+   public:
+    using Grid = std::array<std::uint8_t, kTotalBoardSize>;
+
+    static const int kDefaultPoolSize = 16;
+    static const int kDefaultRefreshInterval = 64;
+
+    explicit GridSampler(const std::uint64_t seed = 0, const int pool_size = kDefaultPoolSize,
+                         const int refresh_interval = kDefaultRefreshInterval);
+
+    // Restarts the sequence of grids from the given seed
+    void Seed(const std::uint64_t seed);
+
+    // Next grid from the pool, randomly transformed
+    void Sample(Grid &grid);
+    Puzzle Sample();
+
+    // A freshly searched grid, randomly transformed
+    void SampleFresh(Grid &grid);
+    Puzzle SampleFresh();
+
+   private:
+    std::uint64_t state_ = 0;
+    int pool_size_;
+    int refresh_interval_;
+    int until_refresh_ = 0;
+    std::vector<Grid> pool_;
+
+    std::uint64_t Next();
+
+    // Uniform in [0, bound)
+    int Below(const int bound);
+
+    template <typename T, std::size_t N>
+    void Shuffle(std::array<T, N> &values);
+
+    void Search(Grid &grid);
+    void Transform(const Grid &source, Grid &grid);
+    static Puzzle ToPuzzle(const Grid &grid);
+};
+}  // namespace Sudoku
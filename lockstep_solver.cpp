@@ -0,0 +1,200 @@
+#include "lockstep_solver.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "candidates.h"
+#include "geometry.h"
+#include "trace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SUDOKU_X86_KERNELS 1
+#endif
+
+namespace Sudoku {
+
+const int LockstepSolver::kLanes;
+
+namespace {
+using Geometry = BoardGeometry<3>;
+
+// One 16 bit mask per puzzle of a group. GCC's vector extensions compile the
+// same source to whatever registers the function's target has.
+typedef std::uint16_t Lanes __attribute__((vector_size(2 * LockstepSolver::kLanes)));
+
+struct Group {
+    Lanes cells[Geometry::kTotalBoardSize];
+    // all ones in the lanes that ran into a contradiction
+    Lanes dead;
+};
+
+// Lanes not holding a puzzle are left all zero; they read as dead straight
+// away and never count as progress.
+
+inline __attribute__((always_inline)) bool AnyLane(const Lanes &lanes) {
+    std::uint16_t any = 0;
+    for (int lane = 0; lane < LockstepSolver::kLanes; ++lane) {
+        any |= lanes[lane];
+    }
+    return any != 0;
+}
+
+// Runs naked and hidden singles over every lane until none of the live ones
+// changes. Masks only ever shrink, so this always ends.
+inline __attribute__((always_inline)) void PropagateGroup(Group &group) {
+    const Lanes all = Lanes{} + Geometry::kAllValues;
+
+    bool changed = true;
+    while (changed) {
+        Lanes delta{};
+
+        // a cell down to one value takes it from all of its peers
+        for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+            const Lanes mask = group.cells[cell];
+            const Lanes placed = mask & (Lanes)((mask & (mask - 1)) == 0);
+
+            for (const int peer : Geometry::kPeers[cell]) {
+                const Lanes before = group.cells[peer];
+                const Lanes after = before & ~placed;
+                delta |= before ^ after;
+                group.cells[peer] = after;
+            }
+        }
+
+        // a value with one place left in a unit goes there
+        for (const auto &unit : Geometry::kUnits) {
+            Lanes once{};
+            Lanes twice{};
+            for (const int cell : unit) {
+                twice |= once & group.cells[cell];
+                once |= group.cells[cell];
+            }
+            group.dead |= (Lanes)(once != all);
+
+            const Lanes hidden = once & ~twice;
+            for (const int cell : unit) {
+                const Lanes before = group.cells[cell];
+                const Lanes mine = before & hidden;
+                // the only place for two values
+                group.dead |= (Lanes)((mine & (mine - 1)) != 0);
+
+                const Lanes keep = (Lanes)(mine == 0);
+                const Lanes after = (before & keep) | (mine & ~keep);
+                delta |= before ^ after;
+                group.cells[cell] = after;
+            }
+        }
+
+        changed = AnyLane(delta & ~group.dead);
+    }
+
+    for (const Lanes &mask : group.cells) {
+        group.dead |= (Lanes)(mask == 0);
+    }
+}
+
+#ifdef SUDOKU_X86_KERNELS
+__attribute__((target("avx2"))) void PropagateAvx2(Group &group) { PropagateGroup(group); }
+#endif
+
+void PropagateDefault(Group &group) { PropagateGroup(group); }
+
+void Propagate(Group &group) {
+#ifdef SUDOKU_X86_KERNELS
+    if (DetectCandidateKernel() == CandidateKernel::kAvx2) {
+        PropagateAvx2(group);
+        return;
+    }
+#endif
+    PropagateDefault(group);
+}
+
+void Load(const std::vector<Puzzle> &puzzles, const std::size_t first, const std::size_t count,
+          Group &group) {
+    for (auto &mask : group.cells) {
+        mask = Lanes{};
+    }
+    group.dead = Lanes{};
+
+    for (std::size_t lane = 0; lane < count; ++lane) {
+        const Puzzle &puzzle = puzzles[first + lane];
+        for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+            const int value = puzzle.GetCell(cell);
+            group.cells[cell][lane] =
+                (value == kUnassigned) ? Geometry::kAllValues : Geometry::ValueBit(value);
+        }
+    }
+}
+
+// Whether every cell of a live lane is down to one value
+bool LaneSolved(const Group &group, const std::size_t lane) {
+    for (const Lanes &mask : group.cells) {
+        if ((mask[lane] & (mask[lane] - 1)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Store(const Group &group, const std::size_t lane, Puzzle &puzzle) {
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (puzzle.GetCell(cell) == kUnassigned) {
+            puzzle.Assign(cell, __builtin_ctz(group.cells[cell][lane]) + 1);
+        }
+    }
+}
+}  // namespace
+
+bool LockstepSolver::SolvePuzzle(Puzzle &puzzle) {
+    last_in_lockstep_ = false;
+    fallback_.SetNodeLimit(this->node_limit_);
+    const bool solved = fallback_.SolvePuzzle(puzzle);
+    this->budget_exhausted_ = fallback_.LastBudgetExhausted();
+    return solved;
+}
+
+std::vector<bool> LockstepSolver::SolvePuzzles(std::vector<Puzzle> &puzzles) {
+    std::vector<bool> solved(puzzles.size(), false);
+    fallbacks_ = 0;
+
+    Group group;
+    for (std::size_t first = 0; first < puzzles.size(); first += kLanes) {
+        const std::size_t count = std::min<std::size_t>(kLanes, puzzles.size() - first);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            SUDOKU_TRACE_SCOPE("propagate");
+            Load(puzzles, first, count, group);
+            Propagate(group);
+        }
+        // lanes finished together share the time evenly
+        const std::uint64_t lane_nanoseconds =
+            RecordingMetrics() ? std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - start)
+                                         .count() /
+                                     count
+                               : 0;
+
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            Puzzle &puzzle = puzzles[first + lane];
+            const bool dead = !puzzle.IsValid() || group.dead[lane] != 0;
+
+            if (!dead && !LaneSolved(group, lane)) {
+                ++fallbacks_;
+                solved[first + lane] = SolveRecorded(puzzle);
+                continue;
+            }
+
+            last_in_lockstep_ = true;
+            this->budget_exhausted_ = false;
+            if (!dead) {
+                Store(group, lane, puzzle);
+                solved[first + lane] = true;
+            }
+            RecordSolve(lane_nanoseconds, !dead);
+        }
+    }
+
+    return solved;
+}
+}  // namespace Sudoku
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "band_solver.h"
+#include "engine.h"
+#include "puzzle.h"
+
+namespace Sudoku {
+
+// Batch engine for 9x9 puzzles that rarely need guessing, such as newspaper
+// puzzles in bulk. SolvePuzzles lays the puzzles out kLanes at a time in
+// structure-of-arrays form, each cell a vector of one 16 bit candidate mask
+// per puzzle, and propagates naked and hidden singles through the whole group
+// in lockstep: one AVX2 register per cell where the CPU has AVX2, two SSE
+// registers otherwise. Puzzles that propagation can't finish drop out to a
+// BandSolver one at a time.
+//
+// Like the other engines it must only be used by one thread at a time.
+class LockstepSolver : public Engine {
+   public:
+    // Puzzles propagated together
+    static const int kLanes = 16;
+
+    const char *Name() const override { return "lockstep"; }
+
+    // A lone puzzle gains nothing from the lanes, so it goes straight to the
+    // band solver
+    bool SolvePuzzle(Puzzle &puzzle) override;
+
+    std::vector<bool> SolvePuzzles(std::vector<Puzzle> &puzzles) override;
+
+    // Propagation only finishes puzzles with a single solution, so only the
+    // band solver's order matters
+    bool SetLexicographic(const bool lexicographic) override {
+        return fallback_.SetLexicographic(lexicographic);
+    }
+
+    // Guesses the band solver made on the last puzzle, 0 if it was finished
+    // in lockstep
+    std::uint64_t LastNodes() const override {
+        return last_in_lockstep_ ? 0 : fallback_.LastNodes();
+    }
+
+    // Puzzles of the last SolvePuzzles that needed the band solver
+    std::size_t LastFallbacks() const { return fallbacks_; }
+
+   private:
+    BandSolver fallback_;
+    std::size_t fallbacks_ = 0;
+    bool last_in_lockstep_ = false;
+};
+}  // namespace Sudoku
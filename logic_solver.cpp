@@ -0,0 +1,706 @@
+#include "logic_solver.h"
+
+#include <algorithm>
+
+#include "trace.h"
+
+namespace Sudoku {
+
+namespace {
+template <typename Bits_t>
+int CountBits(const Bits_t bits) {
+    return __builtin_popcount(bits);
+}
+
+template <typename Bits_t>
+int LowestBitIndex(const Bits_t bits) {
+    return __builtin_ctz(bits);
+}
+
+// Looks for size of the sets whose union has at most size bits, calling
+// found(members, combined) for each such choice until it returns true.
+// members has bit i set for each chosen sets[i].
+template <typename Found>
+bool SearchSubsets(const std::uint32_t *sets, const int count, const int size, const int start,
+                   const int depth, const std::uint32_t members, const std::uint32_t combined,
+                   Found &found) {
+    if (depth == size) {
+        return found(members, combined);
+    }
+
+    for (int i = start; i < count; ++i) {
+        const std::uint32_t next = combined | sets[i];
+        if (CountBits(next) <= size &&
+            SearchSubsets(sets, count, size, i + 1, depth + 1, members | (1u << i), next, found)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+}  // namespace
+
+const char *TechniqueName(const Technique technique) {
+    switch (technique) {
+        case Technique::kHiddenSingle:
+            return "hidden single";
+        case Technique::kNakedSingle:
+            return "naked single";
+        case Technique::kLockedCandidates:
+            return "locked candidates";
+        case Technique::kNakedPair:
+            return "naked pair";
+        case Technique::kXWing:
+            return "x-wing";
+        case Technique::kHiddenPair:
+            return "hidden pair";
+        case Technique::kNakedTriple:
+            return "naked triple";
+        case Technique::kSwordfish:
+            return "swordfish";
+        case Technique::kHiddenTriple:
+            return "hidden triple";
+        case Technique::kXYWing:
+            return "xy-wing";
+        case Technique::kColoring:
+            return "coloring";
+        case Technique::kXYChain:
+            break;
+    }
+
+    return "xy-chain";
+}
+
+double TechniqueDifficulty(const Technique technique) {
+    switch (technique) {
+        case Technique::kHiddenSingle:
+            return 1.5;
+        case Technique::kNakedSingle:
+            return 2.3;
+        case Technique::kLockedCandidates:
+            return 2.6;
+        case Technique::kNakedPair:
+            return 3.0;
+        case Technique::kXWing:
+            return 3.2;
+        case Technique::kHiddenPair:
+            return 3.4;
+        case Technique::kNakedTriple:
+            return 3.6;
+        case Technique::kSwordfish:
+            return 3.8;
+        case Technique::kHiddenTriple:
+            return 4.0;
+        case Technique::kXYWing:
+            return 4.2;
+        case Technique::kColoring:
+            return 4.5;
+        case Technique::kXYChain:
+            break;
+    }
+
+    return 5.0;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) {
+    Rate(puzzle);
+    if (!report_.solved) {
+        return false;
+    }
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (puzzle.GetCell(cell) == kUnassigned) {
+            puzzle.Assign(cell, values_[cell]);
+        }
+    }
+
+    return true;
+}
+
+template <int BoxSize>
+const LogicReport &BasicLogicSolver<BoxSize>::Rate(const BasicPuzzle<BoxSize> &puzzle) {
+    report_ = LogicReport();
+
+    if (!puzzle.IsValid()) {
+        report_.difficulty = kGuessingDifficulty;
+        return report_;
+    }
+
+    // logic solving is all propagation
+    SUDOKU_TRACE_SCOPE("propagate");
+    Load(puzzle);
+    Run();
+
+    report_.solved = (remaining_ == 0 && !broken_);
+    if (!report_.solved) {
+        report_.difficulty = kGuessingDifficulty;
+    }
+
+    return report_;
+}
+
+template <int BoxSize>
+void BasicLogicSolver<BoxSize>::Load(const BasicPuzzle<BoxSize> &puzzle) {
+    CandidateTable<BoxSize> table;
+    puzzle.AllCandidates(table);
+
+    remaining_ = 0;
+    broken_ = false;
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        values_[cell] = static_cast<std::uint8_t>(puzzle.GetCell(cell));
+        candidates_[cell] = table[cell];
+        remaining_ += (values_[cell] == kUnassigned) ? 1 : 0;
+    }
+}
+
+template <int BoxSize>
+void BasicLogicSolver<BoxSize>::Run() {
+    while (remaining_ > 0 && !broken_) {
+        bool progress = false;
+
+        for (int t = 0; t < kTechniqueCount && !progress; ++t) {
+            const Technique technique = static_cast<Technique>(t);
+            if (Apply(technique)) {
+                progress = true;
+                ++report_.uses[t];
+                report_.difficulty =
+                    std::max(report_.difficulty, TechniqueDifficulty(technique));
+            }
+        }
+
+        if (!progress) {
+            return;
+        }
+    }
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::Apply(const Technique technique) {
+    switch (technique) {
+        case Technique::kHiddenSingle:
+            return HiddenSingles();
+        case Technique::kNakedSingle:
+            return NakedSingles();
+        case Technique::kLockedCandidates:
+            return LockedCandidates();
+        case Technique::kNakedPair:
+            return NakedSubsets(2);
+        case Technique::kXWing:
+            return Fish(2);
+        case Technique::kHiddenPair:
+            return HiddenSubsets(2);
+        case Technique::kNakedTriple:
+            return NakedSubsets(3);
+        case Technique::kSwordfish:
+            return Fish(3);
+        case Technique::kHiddenTriple:
+            return HiddenSubsets(3);
+        case Technique::kXYWing:
+            return XYWing();
+        case Technique::kColoring:
+            return Coloring();
+        case Technique::kXYChain:
+            break;
+    }
+
+    return XYChain();
+}
+
+template <int BoxSize>
+void BasicLogicSolver<BoxSize>::Place(const int cell, const int value) {
+    const Mask_t bit = Geometry::ValueBit(value);
+
+    values_[cell] = static_cast<std::uint8_t>(value);
+    candidates_[cell] = 0;
+    --remaining_;
+
+    for (const int peer : Geometry::kPeers[cell]) {
+        if (values_[peer] == value) {
+            broken_ = true;
+        }
+        candidates_[peer] &= static_cast<Mask_t>(~bit);
+        if (values_[peer] == kUnassigned && candidates_[peer] == 0) {
+            broken_ = true;
+        }
+    }
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::Eliminate(const int cell, const Mask_t mask) {
+    if (!(candidates_[cell] & mask)) {
+        return false;
+    }
+
+    candidates_[cell] &= static_cast<Mask_t>(~mask);
+    if (candidates_[cell] == 0) {
+        broken_ = true;
+    }
+
+    return true;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::Sees(const int a, const int b) {
+    return a != b && (Geometry::kRowOf[a] == Geometry::kRowOf[b] ||
+                      Geometry::kColumnOf[a] == Geometry::kColumnOf[b] ||
+                      Geometry::kBoxOf[a] == Geometry::kBoxOf[b]);
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::HiddenSingles() {
+    bool progress = false;
+
+    for (const auto &unit : Geometry::kUnits) {
+        Mask_t once = 0;
+        Mask_t twice = 0;
+        Mask_t placed = 0;
+        for (const int cell : unit) {
+            if (values_[cell] != kUnassigned) {
+                placed |= Geometry::ValueBit(values_[cell]);
+            } else {
+                twice |= once & candidates_[cell];
+                once |= candidates_[cell];
+            }
+        }
+
+        if ((Geometry::kAllValues & ~placed & ~once) != 0) {
+            // some missing value has nowhere to go
+            broken_ = true;
+            return true;
+        }
+
+        for (Mask_t singles = once & ~twice & ~placed; singles != 0; singles &= singles - 1) {
+            const int value = LowestBitIndex(singles) + 1;
+            const auto cell = std::find_if(unit.begin(), unit.end(), [&](const int c) {
+                return candidates_[c] & Geometry::ValueBit(value);
+            });
+
+            if (cell == unit.end()) {
+                broken_ = true;
+                return true;
+            }
+            Place(*cell, value);
+            progress = true;
+        }
+    }
+
+    return progress;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::NakedSingles() {
+    bool progress = false;
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        const Mask_t mask = candidates_[cell];
+        if (values_[cell] == kUnassigned && mask != 0 && (mask & (mask - 1)) == 0) {
+            Place(cell, LowestBitIndex(mask) + 1);
+            progress = true;
+        }
+    }
+
+    return progress;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::LockedCandidates() {
+    const int kBoardSize = Geometry::kBoardSize;
+    bool progress = false;
+
+    for (int box = 0; box < kBoardSize; ++box) {
+        const auto &box_cells = Geometry::kUnits[2 * kBoardSize + box];
+
+        // the lines through the box: BoxSize rows, then BoxSize columns
+        for (int i = 0; i < 2 * BoxSize; ++i) {
+            const bool is_row = i < BoxSize;
+            const int line = is_row ? (box / BoxSize) * BoxSize + i
+                                    : (box % BoxSize) * BoxSize + (i - BoxSize);
+            const auto &line_cells = Geometry::kUnits[is_row ? line : kBoardSize + line];
+            auto on_line = [&](const int cell) {
+                return (is_row ? Geometry::kRowOf[cell] : Geometry::kColumnOf[cell]) == line;
+            };
+
+            Mask_t inside = 0;
+            Mask_t rest_of_box = 0;
+            Mask_t rest_of_line = 0;
+            for (const int cell : box_cells) {
+                (on_line(cell) ? inside : rest_of_box) |= candidates_[cell];
+            }
+            for (const int cell : line_cells) {
+                if (Geometry::kBoxOf[cell] != box) {
+                    rest_of_line |= candidates_[cell];
+                }
+            }
+
+            // pointing: the box's value is confined to the line
+            const Mask_t pointing = inside & static_cast<Mask_t>(~rest_of_box) & rest_of_line;
+            if (pointing) {
+                for (const int cell : line_cells) {
+                    if (Geometry::kBoxOf[cell] != box) {
+                        progress |= Eliminate(cell, pointing);
+                    }
+                }
+            }
+
+            // claiming: the line's value is confined to the box
+            const Mask_t claiming = inside & static_cast<Mask_t>(~rest_of_line) & rest_of_box;
+            if (claiming) {
+                for (const int cell : box_cells) {
+                    if (!on_line(cell)) {
+                        progress |= Eliminate(cell, claiming);
+                    }
+                }
+            }
+
+            if (progress) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::NakedSubsets(const int size) {
+    std::array<std::uint32_t, Geometry::kBoardSize> sets;
+    std::array<int, Geometry::kBoardSize> cells;
+
+    for (const auto &unit : Geometry::kUnits) {
+        int count = 0;
+        for (const int cell : unit) {
+            const int options = CountBits(candidates_[cell]);
+            if (values_[cell] == kUnassigned && options >= 2 && options <= size) {
+                sets[count] = candidates_[cell];
+                cells[count++] = cell;
+            }
+        }
+
+        auto found = [&](const std::uint32_t members, const std::uint32_t combined) {
+            if (CountBits(combined) != size) {
+                return false;
+            }
+
+            bool progress = false;
+            for (const int cell : unit) {
+                bool member = false;
+                for (int i = 0; i < count; ++i) {
+                    member = member || ((members >> i) & 1 && cells[i] == cell);
+                }
+                if (!member && values_[cell] == kUnassigned) {
+                    progress |= Eliminate(cell, static_cast<Mask_t>(combined));
+                }
+            }
+            return progress;
+        };
+
+        if (SearchSubsets(sets.data(), count, size, 0, 0, 0, 0, found)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::HiddenSubsets(const int size) {
+    std::array<std::uint32_t, Geometry::kBoardSize> sets;
+    std::array<int, Geometry::kBoardSize> values;
+
+    for (const auto &unit : Geometry::kUnits) {
+        // sets[i] holds the positions within the unit where values[i] can go
+        int count = 0;
+        for (int value = 1; value <= Geometry::kBoardSize; ++value) {
+            std::uint32_t positions = 0;
+            for (int i = 0; i < Geometry::kBoardSize; ++i) {
+                if (candidates_[unit[i]] & Geometry::ValueBit(value)) {
+                    positions |= 1u << i;
+                }
+            }
+
+            const int options = CountBits(positions);
+            if (options >= 2 && options <= size) {
+                sets[count] = positions;
+                values[count++] = value;
+            }
+        }
+
+        auto found = [&](const std::uint32_t members, const std::uint32_t combined) {
+            if (CountBits(combined) != size) {
+                return false;
+            }
+
+            Mask_t keep = 0;
+            for (std::uint32_t m = members; m != 0; m &= m - 1) {
+                keep |= Geometry::ValueBit(values[LowestBitIndex(m)]);
+            }
+
+            bool progress = false;
+            for (std::uint32_t p = combined; p != 0; p &= p - 1) {
+                progress |= Eliminate(unit[LowestBitIndex(p)], static_cast<Mask_t>(~keep));
+            }
+            return progress;
+        };
+
+        if (SearchSubsets(sets.data(), count, size, 0, 0, 0, 0, found)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::Fish(const int size) {
+    const int kBoardSize = Geometry::kBoardSize;
+    std::array<std::uint32_t, Geometry::kBoardSize> sets;
+    std::array<int, Geometry::kBoardSize> lines;
+
+    for (int value = 1; value <= kBoardSize; ++value) {
+        const Mask_t bit = Geometry::ValueBit(value);
+
+        // base lines are rows, then columns
+        for (int orientation = 0; orientation < 2; ++orientation) {
+            auto cell_at = [&](const int line, const int index) {
+                return orientation == 0 ? line * kBoardSize + index : index * kBoardSize + line;
+            };
+
+            int count = 0;
+            for (int line = 0; line < kBoardSize; ++line) {
+                std::uint32_t positions = 0;
+                for (int index = 0; index < kBoardSize; ++index) {
+                    if (candidates_[cell_at(line, index)] & bit) {
+                        positions |= 1u << index;
+                    }
+                }
+
+                const int options = CountBits(positions);
+                if (options >= 2 && options <= size) {
+                    sets[count] = positions;
+                    lines[count++] = line;
+                }
+            }
+
+            auto found = [&](const std::uint32_t members, const std::uint32_t combined) {
+                if (CountBits(combined) != size) {
+                    return false;
+                }
+
+                std::uint32_t base = 0;
+                for (std::uint32_t m = members; m != 0; m &= m - 1) {
+                    base |= 1u << lines[LowestBitIndex(m)];
+                }
+
+                bool progress = false;
+                for (std::uint32_t p = combined; p != 0; p &= p - 1) {
+                    for (int line = 0; line < kBoardSize; ++line) {
+                        if (!((base >> line) & 1)) {
+                            progress |= Eliminate(cell_at(line, LowestBitIndex(p)), bit);
+                        }
+                    }
+                }
+                return progress;
+            };
+
+            if (SearchSubsets(sets.data(), count, size, 0, 0, 0, 0, found)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::XYWing() {
+    for (int pivot = 0; pivot < Geometry::kTotalBoardSize; ++pivot) {
+        const Mask_t pivot_mask = candidates_[pivot];
+        if (CountBits(pivot_mask) != 2) {
+            continue;
+        }
+
+        for (const int first : Geometry::kPeers[pivot]) {
+            const Mask_t first_mask = candidates_[first];
+            if (CountBits(first_mask) != 2 || CountBits(first_mask & pivot_mask) != 1) {
+                continue;
+            }
+
+            // pincers {x, z} and {y, z} around a pivot {x, y}
+            const Mask_t z = first_mask & static_cast<Mask_t>(~pivot_mask);
+            const Mask_t second_mask = (pivot_mask & static_cast<Mask_t>(~first_mask)) | z;
+
+            for (const int second : Geometry::kPeers[pivot]) {
+                if (second == first || candidates_[second] != second_mask) {
+                    continue;
+                }
+
+                bool progress = false;
+                for (const int cell : Geometry::kPeers[first]) {
+                    if (cell != second && Sees(cell, second)) {
+                        progress |= Eliminate(cell, z);
+                    }
+                }
+                if (progress) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::Coloring() {
+    const int kTotal = Geometry::kTotalBoardSize;
+
+    for (int value = 1; value <= Geometry::kBoardSize; ++value) {
+        const Mask_t bit = Geometry::ValueBit(value);
+
+        // the value's conjugate pairs: units where it has exactly two places
+        auto partners = [&](const int cell, int *out) {
+            int count = 0;
+            const int units[3] = {Geometry::kRowOf[cell],
+                                  Geometry::kBoardSize + Geometry::kColumnOf[cell],
+                                  2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]};
+            for (const int unit : units) {
+                int other = -1;
+                int places = 0;
+                for (const int c : Geometry::kUnits[unit]) {
+                    if (candidates_[c] & bit) {
+                        ++places;
+                        if (c != cell) {
+                            other = c;
+                        }
+                    }
+                }
+                if (places == 2) {
+                    out[count++] = other;
+                }
+            }
+            return count;
+        };
+
+        colors_.assign(kTotal, -1);
+        for (int start = 0; start < kTotal; ++start) {
+            int links[3];
+            if (colors_[start] >= 0 || !(candidates_[start] & bit) || partners(start, links) == 0) {
+                continue;
+            }
+
+            // two-color the chain of conjugate pairs through start
+            queue_.clear();
+            queue_.push_back(start);
+            colors_[start] = 0;
+            for (std::size_t head = 0; head < queue_.size(); ++head) {
+                const int cell = queue_[head];
+                const int count = partners(cell, links);
+                for (int i = 0; i < count; ++i) {
+                    if (colors_[links[i]] < 0) {
+                        colors_[links[i]] = static_cast<std::int8_t>(1 - colors_[cell]);
+                        queue_.push_back(links[i]);
+                    }
+                }
+            }
+
+            // Two cells of one color seeing each other make that color false
+            for (std::size_t i = 0; i < queue_.size(); ++i) {
+                for (std::size_t j = i + 1; j < queue_.size(); ++j) {
+                    if (colors_[queue_[i]] != colors_[queue_[j]] || !Sees(queue_[i], queue_[j])) {
+                        continue;
+                    }
+
+                    const int wrong = colors_[queue_[i]];
+                    for (const int cell : queue_) {
+                        if (colors_[cell] == wrong) {
+                            Eliminate(cell, bit);
+                        }
+                    }
+                    return true;
+                }
+            }
+
+            // A cell seeing both colors can't hold the value
+            bool progress = false;
+            for (int cell = 0; cell < kTotal; ++cell) {
+                if (!(candidates_[cell] & bit) ||
+                    std::find(queue_.begin(), queue_.end(), cell) != queue_.end()) {
+                    continue;
+                }
+
+                bool sees[2] = {false, false};
+                for (const int member : queue_) {
+                    if (Sees(cell, member)) {
+                        sees[colors_[member]] = true;
+                    }
+                }
+                if (sees[0] && sees[1]) {
+                    progress |= Eliminate(cell, bit);
+                }
+            }
+            if (progress) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+template <int BoxSize>
+bool BasicLogicSolver<BoxSize>::XYChain() {
+    const int kTotal = Geometry::kTotalBoardSize;
+
+    for (int start = 0; start < kTotal; ++start) {
+        if (CountBits(candidates_[start]) != 2) {
+            continue;
+        }
+
+        for (Mask_t ends = candidates_[start]; ends != 0; ends &= ends - 1) {
+            // Suppose start isn't the end value; follow the implications
+            // through two-candidate cells, queued with the value they'd take
+            const Mask_t end = ends & static_cast<Mask_t>(-ends);
+            visited_.assign(kTotal, 0);
+            queue_.clear();
+            queue_.push_back(start);
+            visited_[start] = candidates_[start] & static_cast<Mask_t>(~end);
+
+            for (std::size_t head = 0; head < queue_.size(); ++head) {
+                const int cell = queue_[head];
+                const Mask_t value = visited_[cell];
+
+                for (const int next : Geometry::kPeers[cell]) {
+                    if (next == start || CountBits(candidates_[next]) != 2 ||
+                        !(candidates_[next] & value)) {
+                        continue;
+                    }
+
+                    const Mask_t implied = candidates_[next] & static_cast<Mask_t>(~value);
+                    if (implied == end) {
+                        // either start or next holds the end value
+                        bool progress = false;
+                        for (const int cell_seen : Geometry::kPeers[start]) {
+                            if (cell_seen != next && Sees(cell_seen, next)) {
+                                progress |= Eliminate(cell_seen, end);
+                            }
+                        }
+                        if (progress) {
+                            return true;
+                        }
+                    } else if (visited_[next] == 0) {
+                        visited_[next] = implied;
+                        queue_.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+template class BasicLogicSolver<3>;
+template class BasicLogicSolver<4>;
+template class BasicLogicSolver<5>;
+}  // namespace Sudoku
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+#include "puzzle.h"
+
+namespace Sudoku {
+
+// Logical techniques known to LogicSolver, from cheapest to most expensive.
+// This is also the order they are tried in.
+enum class Technique {
+    kHiddenSingle,
+    kNakedSingle,
+    kLockedCandidates,
+    kNakedPair,
+    kXWing,
+    kHiddenPair,
+    kNakedTriple,
+    kSwordfish,
+    kHiddenTriple,
+    kXYWing,
+    kColoring,
+    kXYChain,
+};
+
+const int kTechniqueCount = static_cast<int>(Technique::kXYChain) + 1;
+
+// Rating given to puzzles that can't be finished without guessing
+const double kGuessingDifficulty = 10.0;
+
+// Returns a printable name for the technique
+const char *TechniqueName(const Technique technique);
+
+// Difficulty of a single application of the technique, on a scale close to
+// the one used by Sudoku Explainer
+double TechniqueDifficulty(const Technique technique);
+
+// What it took to solve a puzzle with logic alone
+struct LogicReport {
+    bool solved = false;
+
+    // Difficulty of the hardest step, or kGuessingDifficulty if logic alone
+    // wasn't enough
+    double difficulty = 0.0;
+
+    // Number of times each technique made progress
+    std::array<int, kTechniqueCount> uses{};
+
+    bool Used(const Technique technique) const {
+        return uses[static_cast<int>(technique)] > 0;
+    }
+};
+
+// Solves puzzles the way a person would, without guessing: every step applies
+// the cheapest technique that places a value or removes a candidate. The
+// techniques work directly on a grid of candidate masks, so rating large
+// batches stays cheap.
+//
+// Chains are XY-chains (chains of two-candidate cells); coloring is simple
+// single-value coloring. Puzzles needing anything stronger are left
+// unsolved and rated kGuessingDifficulty.
+template <int BoxSize>
+class BasicLogicSolver : public BasicEngine<BoxSize> {
+   public:
+    using Geometry = BoardGeometry<BoxSize>;
+    using Mask_t = typename Geometry::Mask_t;
+
+    const char *Name() const override { return "logic"; }
+
+    // Solves the puzzle with logic alone. Returns false, leaving the puzzle
+    // untouched, if that isn't enough.
+    bool SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) override;
+
+    // Logic only ever finishes puzzles with a single solution, so there's no
+    // order to choose
+    bool SetLexicographic(const bool) override { return true; }
+
+    // Rates a puzzle without changing it
+    const LogicReport &Rate(const BasicPuzzle<BoxSize> &puzzle);
+
+    // Report of the last SolvePuzzle or Rate
+    const LogicReport &LastReport() const { return report_; }
+
+   private:
+    using Cell_t = typename Geometry::Cell_t;
+
+    std::array<std::uint8_t, Geometry::kTotalBoardSize> values_;
+    std::array<Mask_t, Geometry::kTotalBoardSize> candidates_;
+    int remaining_ = 0;
+    bool broken_ = false;
+    LogicReport report_;
+
+    // Scratch space for coloring and chains
+    std::vector<int> queue_;
+    std::vector<std::int8_t> colors_;
+    std::vector<Mask_t> visited_;
+
+    void Load(const BasicPuzzle<BoxSize> &puzzle);
+    void Run();
+
+    void Place(const int cell, const int value);
+    bool Eliminate(const int cell, const Mask_t mask);
+    static bool Sees(const int a, const int b);
+
+    bool Apply(const Technique technique);
+    bool HiddenSingles();
+    bool NakedSingles();
+    bool LockedCandidates();
+    bool NakedSubsets(const int size);
+    bool HiddenSubsets(const int size);
+    bool Fish(const int size);
+    bool XYWing();
+    bool Coloring();
+    bool XYChain();
+};
+
+using LogicSolver = BasicLogicSolver<3>;
+using LogicSolver16 = BasicLogicSolver<4>;
+using LogicSolver25 = BasicLogicSolver<5>;
+
+// Instantiated in logic_solver.cpp
+extern template class BasicLogicSolver<3>;
+extern template class BasicLogicSolver<4>;
+extern template class BasicLogicSolver<5>;
+}  // namespace Sudoku
@@ -1,10 +1,383 @@
 #include "generator.h"
+#include "search_checkpoint.h"
+#include "server.h"
 #include "solver.h"
+#include "trace.h"
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+// Runs the solve server until SIGINT or SIGTERM
+int Serve(const Sudoku::ServerOptions& options, const std::string& trace_path) {
+  // Block the signals before any thread starts so they all inherit the mask,
+  // and wait for them on a thread of our own instead
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  try {
+    Sudoku::Server server(options);
+    server.Listen();
+
+    std::thread waiter([&] {
+      int signal_number;
+      sigwait(&signals, &signal_number);
+      server.Stop();
+    });
+
+    std::cout << "Serving on " << options.socket_path << std::endl;
+    try {
+      server.Run();
+    } catch (...) {
+      // wake the waiter with one of its own signals, since destroying it
+      // unjoined would terminate the process
+      pthread_kill(waiter.native_handle(), SIGTERM);
+      waiter.join();
+      throw;
+    }
+    waiter.join();
+
+    if (!trace_path.empty()) {
+      std::ofstream trace(trace_path);
+      Sudoku::WriteChromeTrace(trace);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Server failed: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+// Solves every puzzle of an SPF file with one engine, printing each solution
+// (or the server's unsolvable reply) on its own line, in input order. In
+// deterministic mode puzzles with several solutions get the lexicographically
+// first.
+int SolveBatch(const std::string& path, const std::string& engine_name, const bool deterministic,
+               const std::string& trace_path) {
+  std::unique_ptr<Sudoku::Engine> engine = Sudoku::MakeEngine(engine_name);
+  if (!engine) {
+    std::cerr << "Unknown engine: " << engine_name << std::endl;
+    return 1;
+  }
+  if (!engine->SetLexicographic(deterministic)) {
+    std::cerr << "Engine " << engine_name << " has no deterministic mode" << std::endl;
+    return 1;
+  }
+
+  std::vector<Sudoku::Puzzle> puzzles;
+  try {
+    std::ifstream input(path);
+    if (!input) {
+      throw std::runtime_error("can't open " + path);
+    }
+    puzzles = Sudoku::Generator::ReadPuzzles(input);
+  } catch (const std::exception& e) {
+    std::cerr << "Could not read puzzles: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::vector<bool> solved = engine->SolvePuzzles(puzzles);
+
+  std::string output;
+  for (std::size_t i = 0; i < puzzles.size(); ++i) {
+    output += solved[i] ? puzzles[i].ToString() : Sudoku::kUnsolvableReply;
+    output += '\n';
+  }
+  std::cout << output << std::flush;
+
+  if (!trace_path.empty()) {
+    std::ofstream trace(trace_path);
+    Sudoku::WriteChromeTrace(trace);
+  }
+
+  return 0;
+}
+
+// Settings of a single long backtracking solve, started from a board or
+// resumed from a checkpoint
+struct LongSolveOptions {
+  std::string board_path;
+  std::string resume_path;
+  std::string checkpoint_path;
+  std::uint64_t checkpoint_nodes = 0;
+  // branch in lexicographic order; a resumed search keeps its checkpoint's
+  // order, which must then be lexicographic too
+  bool deterministic = false;
+};
+
+// Replaces path with the checkpoint through a temporary file, so a crash
+// part way through writing never leaves a torn checkpoint behind
+template <int BoxSize>
+void SaveCheckpoint(const Sudoku::BasicSearchCheckpoint<BoxSize>& checkpoint,
+                    const std::string& path) {
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream output(temporary);
+    checkpoint.Write(output);
+    output.flush();
+    if (!output) {
+      std::cerr << "Could not write checkpoint " << temporary << std::endl;
+      return;
+    }
+  }
+
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::cerr << "Could not replace checkpoint " << path << std::endl;
+  }
+}
+
+// Solves one board with the backtracking solver, checkpointing to
+// options.checkpoint_path every options.checkpoint_nodes nodes and on SIGUSR1.
+// SIGINT and SIGTERM checkpoint and stop, so the solve can be resumed later.
+// In deterministic mode a board with several solutions gets the
+// lexicographically first.
+template <int BoxSize>
+int SolveLong(const LongSolveOptions& options, const std::string& board, std::istream* resume) {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  sigaddset(&signals, SIGUSR1);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  Sudoku::BasicSolver<BoxSize> solver;
+  solver.SetLexicographic(options.deterministic);
+  if (!options.checkpoint_path.empty()) {
+    solver.SetCheckpointHandler(options.checkpoint_nodes,
+                                [&](const Sudoku::BasicSearchCheckpoint<BoxSize>& checkpoint) {
+                                  SaveCheckpoint(checkpoint, options.checkpoint_path);
+                                });
+  }
+
+  std::atomic<bool> finished{false};
+  std::thread waiter([&] {
+    while (true) {
+      int signal_number;
+      sigwait(&signals, &signal_number);
+      if (finished) {
+        return;
+      }
+
+      if (signal_number == SIGUSR1) {
+        solver.RequestCheckpoint();
+      } else {
+        solver.RequestStop();
+      }
+    }
+  });
+
+  bool solved = false;
+  Sudoku::BasicPuzzle<BoxSize> puzzle;
+  int status = 0;
+  try {
+    if (resume != nullptr) {
+      const auto checkpoint = Sudoku::BasicSearchCheckpoint<BoxSize>::Read(*resume);
+      if (options.deterministic && !checkpoint.lexicographic) {
+        throw std::invalid_argument("checkpoint wasn't taken with --deterministic");
+      }
+      solved = solver.Resume(checkpoint, puzzle);
+    } else {
+      puzzle = Sudoku::BasicPuzzle<BoxSize>(board);
+      solved = solver.SolvePuzzle(puzzle);
+    }
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Could not start the search: " << e.what() << std::endl;
+    status = 1;
+  }
+
+  finished = true;
+  pthread_kill(waiter.native_handle(), SIGUSR1);
+  waiter.join();
+
+  if (status != 0) {
+    return status;
+  }
+
+  if (solver.LastInterrupted()) {
+    std::cerr << "Stopped after " << solver.LastNodes() << " nodes";
+    if (!options.checkpoint_path.empty()) {
+      std::cerr << "; resume with --resume " << options.checkpoint_path;
+    }
+    std::cerr << std::endl;
+    return 2;
+  }
+
+  std::cout << (solved ? puzzle.ToString() : Sudoku::kUnsolvableReply) << std::endl;
+  return 0;
+}
+
+// Reads the board or checkpoint named in options and runs SolveLong for its
+// board size
+int SolveLong(const LongSolveOptions& options) {
+  std::string board;
+  std::ifstream resume;
+  int box_size = 0;
+
+  try {
+    if (!options.resume_path.empty()) {
+      resume.open(options.resume_path);
+      if (!resume) {
+        throw std::runtime_error("can't open " + options.resume_path);
+      }
+      box_size = Sudoku::PeekCheckpointBoxSize(resume);
+    } else {
+      std::ifstream input(options.board_path);
+      if (!input) {
+        throw std::runtime_error("can't open " + options.board_path);
+      }
+      // the first line that isn't an SPF comment
+      while (std::getline(input, board) && (board.empty() || board[0] == '#')) {
+      }
+
+      for (int size = 3; size <= 5; ++size) {
+        if (board.size() == static_cast<std::size_t>(size * size * size * size)) {
+          box_size = size;
+        }
+      }
+      if (box_size == 0) {
+        throw std::runtime_error("no 9x9, 16x16 or 25x25 board in " + options.board_path);
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Could not read puzzle: " << e.what() << std::endl;
+    return 1;
+  }
+
+  std::istream* checkpoint = options.resume_path.empty() ? nullptr : &resume;
+  switch (box_size) {
+    case 3:
+      return SolveLong<3>(options, board, checkpoint);
+    case 4:
+      return SolveLong<4>(options, board, checkpoint);
+    case 5:
+      return SolveLong<5>(options, board, checkpoint);
+    default:
+      std::cerr << "Unsupported box size " << box_size << std::endl;
+      return 1;
+  }
+}
+
+void PrintUsage() {
+  std::cerr << "usage: sudoku [--batch FILE [--engine NAME] [--deterministic] [--trace-file PATH]]"
+            << std::endl
+            << "       sudoku [--solve FILE | --resume CHECKPOINT] [--checkpoint-file PATH]"
+            << std::endl
+            << "                            [--checkpoint-nodes N] [--deterministic]" << std::endl
+            << "       sudoku [--serve SOCKET_PATH [--engine NAME] [--threads N]" << std::endl
+            << "                            [--batch-size N] [--batch-wait-us MICROSECONDS]"
+            << std::endl
+            << "                            [--max-pending N] [--shed reject|drop-oldest|degrade]"
+            << std::endl
+            << "                            [--degrade-engine NAME] [--degrade-nodes N]"
+            << std::endl
+            << "                            [--deterministic]" << std::endl
+            << "                            [--metrics-file PATH] [--metrics-interval-ms MS]"
+            << std::endl
+            << "                            [--trace-file PATH]]" << std::endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    Sudoku::ServerOptions options;
+    std::string trace_path;
+    std::string batch_path;
+    LongSolveOptions long_solve;
+
+    for (int i = 1; i < argc; ++i) {
+      std::string argument = argv[i];
+      if (argument == "--deterministic") {
+        options.batch.deterministic = true;
+        long_solve.deterministic = true;
+        continue;
+      }
+
+      if (i + 1 >= argc) {
+        PrintUsage();
+        return 1;
+      }
+
+      if (argument == "--serve") {
+        options.socket_path = argv[++i];
+      } else if (argument == "--batch") {
+        batch_path = argv[++i];
+      } else if (argument == "--solve") {
+        long_solve.board_path = argv[++i];
+      } else if (argument == "--resume") {
+        long_solve.resume_path = argv[++i];
+      } else if (argument == "--checkpoint-file") {
+        long_solve.checkpoint_path = argv[++i];
+      } else if (argument == "--checkpoint-nodes") {
+        long_solve.checkpoint_nodes = std::strtoull(argv[++i], nullptr, 10);
+      } else if (argument == "--engine") {
+        options.engine = argv[++i];
+      } else if (argument == "--threads") {
+        options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+      } else if (argument == "--batch-size") {
+        options.batch.max_batch_size = std::strtoul(argv[++i], nullptr, 10);
+      } else if (argument == "--batch-wait-us") {
+        options.batch.max_wait = std::chrono::microseconds(std::strtoul(argv[++i], nullptr, 10));
+      } else if (argument == "--max-pending") {
+        options.batch.max_pending = std::strtoul(argv[++i], nullptr, 10);
+      } else if (argument == "--shed") {
+        try {
+          options.batch.shed_policy = Sudoku::ParseShedPolicy(argv[++i]);
+        } catch (const std::invalid_argument& e) {
+          std::cerr << e.what() << std::endl;
+          return 1;
+        }
+      } else if (argument == "--degrade-engine") {
+        options.batch.degrade_engine = argv[++i];
+      } else if (argument == "--degrade-nodes") {
+        options.batch.degrade_node_limit = std::strtoull(argv[++i], nullptr, 10);
+      } else if (argument == "--metrics-file") {
+        options.metrics_path = argv[++i];
+      } else if (argument == "--metrics-interval-ms") {
+        options.metrics_interval = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+      } else if (argument == "--trace-file") {
+        trace_path = argv[++i];
+        if (!Sudoku::kTracingEnabled) {
+          std::cerr << "Tracing isn't compiled in; rebuild with make TRACE=1" << std::endl;
+          return 1;
+        }
+      } else {
+        PrintUsage();
+        return 1;
+      }
+    }
+
+    const int modes = !options.socket_path.empty() + !batch_path.empty() +
+                      !long_solve.board_path.empty() + !long_solve.resume_path.empty();
+    if (modes != 1) {
+      PrintUsage();
+      return 1;
+    }
+
+    if (!long_solve.board_path.empty() || !long_solve.resume_path.empty()) {
+      return SolveLong(long_solve);
+    }
+
+    if (!batch_path.empty()) {
+      return SolveBatch(batch_path, options.engine, options.batch.deterministic, trace_path);
+    }
+
+    return Serve(options, trace_path);
+  }
 
-int main() {
   Sudoku::Generator generator;
   Sudoku::Solver solver;
 
@@ -21,4 +394,4 @@ int main() {
   }
 
   return 0;
-}
\ No newline at end of file
+}
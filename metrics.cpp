@@ -0,0 +1,167 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace Sudoku {
+
+const int HistogramSnapshot::kSubBuckets;
+const int HistogramSnapshot::kBucketCount;
+
+int HistogramSnapshot::BucketOf(const std::uint64_t value) {
+    if (value < 2 * kSubBuckets) {
+        return static_cast<int>(value);
+    }
+
+    // the leading bit picks the power of two, the four bits after it the
+    // bucket within it
+    const int top_bit = 63 - __builtin_clzll(value);
+    const int shift = top_bit - 4;
+    return (top_bit - 3) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+}
+
+std::uint64_t HistogramSnapshot::LowerBound(const int bucket) {
+    if (bucket < 2 * kSubBuckets) {
+        return static_cast<std::uint64_t>(bucket);
+    }
+
+    const int shift = bucket / kSubBuckets - 1;
+    return static_cast<std::uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+}
+
+std::uint64_t HistogramSnapshot::UpperBound(const int bucket) {
+    if (bucket < 2 * kSubBuckets) {
+        return static_cast<std::uint64_t>(bucket);
+    }
+
+    const int shift = bucket / kSubBuckets - 1;
+    return LowerBound(bucket) + ((std::uint64_t{1} << shift) - 1);
+}
+
+std::uint64_t HistogramSnapshot::CountAtMost(const std::uint64_t value) const {
+    std::uint64_t total = 0;
+    for (int bucket = 0; bucket < kBucketCount && UpperBound(bucket) <= value; ++bucket) {
+        total += counts[bucket];
+    }
+
+    return total;
+}
+
+std::uint64_t HistogramSnapshot::Quantile(const double quantile) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(quantile * count));
+    rank = (rank == 0) ? 1 : rank;
+
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return UpperBound(bucket);
+        }
+    }
+
+    return UpperBound(kBucketCount - 1);
+}
+
+Histogram::Histogram() {
+    for (auto &count : counts_) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::AddTo(HistogramSnapshot &snapshot) const {
+    for (int bucket = 0; bucket < HistogramSnapshot::kBucketCount; ++bucket) {
+        const std::uint64_t count = counts_[bucket].load(std::memory_order_relaxed);
+        snapshot.counts[bucket] += count;
+        snapshot.count += count;
+    }
+    snapshot.sum += sum_.load(std::memory_order_relaxed);
+}
+
+EngineMetrics::EngineMetrics(const std::string &engine, const unsigned shards)
+    : engine_(engine),
+      shard_count_(shards == 0 ? 1 : shards),
+      shards_(new Shard[shard_count_]) {}
+
+void EngineMetrics::Record(const unsigned shard, const std::uint64_t nanoseconds,
+                           const std::uint64_t nodes, const bool solved, const bool gave_up) {
+    Shard &mine = shards_[shard % shard_count_];
+
+    if (solved) {
+        mine.solved.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        mine.unsolved.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (gave_up) {
+        mine.gave_up.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    mine.latency.Record(nanoseconds);
+    mine.nodes.Record(nodes);
+}
+
+EngineMetrics::Totals EngineMetrics::Collect() const {
+    Totals totals;
+    for (unsigned shard = 0; shard < shard_count_; ++shard) {
+        const Shard &source = shards_[shard];
+        totals.solved += source.solved.load(std::memory_order_relaxed);
+        totals.unsolved += source.unsolved.load(std::memory_order_relaxed);
+        totals.gave_up += source.gave_up.load(std::memory_order_relaxed);
+        source.latency.AddTo(totals.latency);
+        source.nodes.AddTo(totals.nodes);
+    }
+
+    return totals;
+}
+
+void MetricsText::Family(const std::string &name, const char *type, const char *help) {
+    text_ += "# HELP " + name + " " + help + "\n";
+    text_ += "# TYPE " + name + " " + type + "\n";
+}
+
+void MetricsText::Name(const std::string &name, const std::string &labels) {
+    text_ += name;
+    if (!labels.empty()) {
+        text_ += "{" + labels + "}";
+    }
+    text_ += ' ';
+}
+
+void MetricsText::Sample(const std::string &name, const std::string &labels,
+                         const double value) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.9g", value);
+
+    Name(name, labels);
+    text_ += number;
+    text_ += '\n';
+}
+
+void MetricsText::Sample(const std::string &name, const std::string &labels,
+                         const std::uint64_t value) {
+    Name(name, labels);
+    text_ += std::to_string(value);
+    text_ += '\n';
+}
+
+void MetricsText::Histogram(const std::string &name, const std::string &labels,
+                            const HistogramSnapshot &snapshot,
+                            const std::vector<std::uint64_t> &bounds, const double scale) {
+    const std::string prefix = labels.empty() ? std::string() : labels + ",";
+
+    for (const std::uint64_t bound : bounds) {
+        const std::uint64_t edge =
+            HistogramSnapshot::UpperBound(HistogramSnapshot::BucketOf(bound));
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.9g", edge / scale);
+        Sample(name + "_bucket", prefix + "le=\"" + number + "\"", snapshot.CountAtMost(edge));
+    }
+    Sample(name + "_bucket", prefix + "le=\"+Inf\"", snapshot.count);
+    Sample(name + "_sum", labels, snapshot.sum / scale);
+    Sample(name + "_count", labels, snapshot.count);
+}
+}  // namespace Sudoku
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sudoku {
+
+// Merged counts of one or more Histograms. Buckets are log-linear in the
+// style of HDR histograms: one per value below 32, then 16 per power of two,
+// so every value is within about 6% of its bucket's bounds whatever its
+// magnitude.
+struct HistogramSnapshot {
+    static const int kSubBuckets = 16;
+    static const int kBucketCount = 61 * kSubBuckets;
+
+    static int BucketOf(const std::uint64_t value);
+
+    // Smallest and largest values counted in a bucket
+    static std::uint64_t LowerBound(const int bucket);
+    static std::uint64_t UpperBound(const int bucket);
+
+    std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(kBucketCount);
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+
+    // Values recorded that are at most value, counting only whole buckets
+    std::uint64_t CountAtMost(const std::uint64_t value) const;
+
+    // Upper bound of the bucket holding the given quantile (0 to 1), or 0 if
+    // nothing was recorded
+    std::uint64_t Quantile(const double quantile) const;
+};
+
+// Histogram of non-negative values that any number of threads can record
+// into without locking. Give each busy thread its own to avoid sharing
+// cache lines, and merge them when reading.
+class Histogram {
+   public:
+    Histogram();
+
+    Histogram(const Histogram &) = delete;
+    Histogram &operator=(const Histogram &) = delete;
+
+    void Record(const std::uint64_t value) {
+        counts_[HistogramSnapshot::BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    // Adds the counts so far to snapshot
+    void AddTo(HistogramSnapshot &snapshot) const;
+
+   private:
+    std::array<std::atomic<std::uint64_t>, HistogramSnapshot::kBucketCount> counts_;
+    std::atomic<std::uint64_t> sum_;
+};
+
+// Outcomes, solve times and search sizes of the puzzles a set of engines
+// running the same algorithm solve, recorded through
+// BasicEngine::AttachMetrics. Each recording thread writes to a shard of its
+// own, so recording is a handful of uncontended atomic adds.
+class EngineMetrics {
+   public:
+    struct Totals {
+        std::uint64_t solved = 0;
+        std::uint64_t unsolved = 0;
+        // unsolved because the node limit ran out
+        std::uint64_t gave_up = 0;
+        // nanoseconds per puzzle
+        HistogramSnapshot latency;
+        // BasicEngine::LastNodes per puzzle
+        HistogramSnapshot nodes;
+    };
+
+    EngineMetrics(const std::string &engine, const unsigned shards);
+
+    EngineMetrics(const EngineMetrics &) = delete;
+    EngineMetrics &operator=(const EngineMetrics &) = delete;
+
+    const std::string &Engine() const { return engine_; }
+    unsigned Shards() const { return shard_count_; }
+
+    void Record(const unsigned shard, const std::uint64_t nanoseconds, const std::uint64_t nodes,
+                const bool solved, const bool gave_up);
+
+    // Merges every shard
+    Totals Collect() const;
+
+   private:
+    struct Shard {
+        std::atomic<std::uint64_t> solved{0};
+        std::atomic<std::uint64_t> unsolved{0};
+        std::atomic<std::uint64_t> gave_up{0};
+        Histogram latency;
+        Histogram nodes;
+        // keeps the next shard's counters off this one's cache lines
+        char padding[64];
+    };
+
+    std::string engine_;
+    unsigned shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+// Builds a page in the Prometheus text exposition format
+class MetricsText {
+   public:
+    // Starts a metric family; type is "counter", "gauge" or "histogram"
+    void Family(const std::string &name, const char *type, const char *help);
+
+    // labels is a comma separated list such as engine="band", or empty
+    void Sample(const std::string &name, const std::string &labels, const double value);
+    void Sample(const std::string &name, const std::string &labels, const std::uint64_t value);
+
+    // Writes the _bucket, _sum and _count samples of a histogram family, with
+    // buckets at bounds. The counts can't split a snapshot bucket, so each
+    // bound is moved up to the upper edge of the bucket holding it, keeping
+    // le inclusive: a value equal to a bound is counted under it. Recorded
+    // values are divided by scale, so latencies recorded in nanoseconds can
+    // be shown in seconds.
+    void Histogram(const std::string &name, const std::string &labels,
+                   const HistogramSnapshot &snapshot, const std::vector<std::uint64_t> &bounds,
+                   const double scale);
+
+    const std::string &Text() const { return text_; }
+
+   private:
+    std::string text_;
+
+    void Name(const std::string &name, const std::string &labels);
+};
+}  // namespace Sudoku
@@ -0,0 +1,130 @@
+#include "alloc_counter.h"
+#include "puzzle.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Times the Puzzle primitives that every engine and the I/O path are built
+// from, one at a time, and reports the time and heap allocations per call.
+namespace {
+// A puzzle from the bundled corpus, and the same board solved but for its
+// last cell, which is the slowest case for FindUnassignedPosition
+const std::string kPuzzle =
+    "_6_47__9__________8__5________3_7_6__4_9__8_2____547___13___5____4_3______76_52__";
+const std::string kLastCellEmpty =
+    "56247319843918265787159632419832746574596183232685471921374958665423897198761524_";
+
+// Keeps the compiler from dropping a result it can see is unused
+template <typename T>
+void KeepResult(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Stream buffer that throws everything away, so operator<< is timed
+// without a growing string behind it
+class NullBuffer : public std::streambuf {
+ protected:
+  int overflow(int c) override { return traits_type::not_eof(c); }
+  std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+struct Benchmark {
+  const char* name;
+  std::function<void()> op;
+};
+
+struct Measurement {
+  double ns_per_op = 0;
+  double allocations_per_op = 0;
+  double bytes_per_op = 0;
+};
+
+// Runs op in batches, doubling the batch until one takes at least the target
+// time, and reports the last batch. One untimed call first warms caches and
+// any lazily built tables.
+Measurement Measure(const std::function<void()>& op) {
+  using Clock = std::chrono::steady_clock;
+  const std::chrono::milliseconds target(200);
+
+  op();
+
+  Measurement measurement;
+  for (long iterations = 1;; iterations *= 2) {
+    const Sudoku::AllocationCounts before = Sudoku::ThreadAllocations();
+    const Clock::time_point start = Clock::now();
+    for (long i = 0; i < iterations; ++i) {
+      op();
+    }
+    const Clock::duration elapsed = Clock::now() - start;
+    const Sudoku::AllocationCounts after = Sudoku::ThreadAllocations();
+
+    if (elapsed >= target || iterations >= (1L << 40)) {
+      measurement.ns_per_op =
+          std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+      measurement.allocations_per_op =
+          static_cast<double>(after.allocations - before.allocations) / iterations;
+      measurement.bytes_per_op = static_cast<double>(after.bytes - before.bytes) / iterations;
+      return measurement;
+    }
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+    std::fprintf(stderr, "usage: microbench [FILTER]\n");
+    std::fprintf(stderr, "  Runs the benchmarks whose names contain FILTER, or all of them.\n");
+    return 1;
+  }
+  const char* filter = (argc == 2) ? argv[1] : "";
+
+  const Sudoku::Puzzle puzzle(kPuzzle);
+  const Sudoku::Puzzle last_cell_empty(kLastCellEmpty);
+  NullBuffer null_buffer;
+  std::ostream null_stream(&null_buffer);
+
+  // Rows, columns and values cycle so no call sees the same arguments as
+  // the last one
+  int index = 0;
+  auto next = [&index]() { return index = (index + 1) % Sudoku::kBoardSize; };
+
+  // Every time includes calling op through std::function; "overhead" times
+  // just that, to subtract from the rest
+  const std::vector<Benchmark> benchmarks{
+      {"overhead", []() {}},
+      {"BuildBoardVector",
+       [&]() { KeepResult(Sudoku::Puzzle::BuildBoardVector(kPuzzle)[0][0]); }},
+      {"ToString", [&]() { KeepResult(puzzle.ToString()[0]); }},
+      {"GetRow", [&]() { KeepResult(puzzle.GetRow(next())[0]); }},
+      {"GetColumn", [&]() { KeepResult(puzzle.GetColumn(next())[0]); }},
+      {"IsValidAssignment",
+       [&]() {
+         const int row = next();
+         KeepResult(puzzle.IsValidAssignment({row, (row * 4) % Sudoku::kBoardSize}, row + 1));
+       }},
+      {"IsValid", [&]() { KeepResult(puzzle.IsValid()); }},
+      {"FindUnassignedPosition", [&]() { KeepResult(puzzle.FindUnassignedPosition()); }},
+      {"FindUnassignedPosition/last",
+       [&]() { KeepResult(last_cell_empty.FindUnassignedPosition()); }},
+      {"operator<<", [&]() { null_stream << puzzle; }},
+  };
+
+  std::printf("%-28s %10s %10s %10s\n", "benchmark", "ns/op", "allocs/op", "bytes/op");
+  for (const Benchmark& benchmark : benchmarks) {
+    if (std::strstr(benchmark.name, filter) == nullptr) {
+      continue;
+    }
+
+    const Measurement measurement = Measure(benchmark.op);
+    std::printf("%-28s %10.1f %10.2f %10.1f\n", benchmark.name, measurement.ns_per_op,
+                measurement.allocations_per_op, measurement.bytes_per_op);
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Sudoku {
+
+namespace {
+#ifdef __linux__
+struct EventConfig {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+// Indexed by PerfEvent
+const EventConfig kEventConfigs[kPerfEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+};
+
+int OpenEvent(const EventConfig &config, const int group) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = config.type;
+    attributes.config = config.config;
+    attributes.disabled = (group < 0) ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // this thread, on whatever CPU it runs
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, group, 0));
+}
+#endif
+}  // namespace
+
+const char *PerfEventName(const PerfEvent event) {
+    switch (event) {
+        case PerfEvent::kCycles:
+            return "cycles";
+        case PerfEvent::kInstructions:
+            return "instructions";
+        case PerfEvent::kBranchMisses:
+            return "branch-misses";
+        case PerfEvent::kL1DataMisses:
+            return "L1-dcache-load-misses";
+        case PerfEvent::kLastLevelMisses:
+            break;
+    }
+
+    return "LLC-misses";
+}
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+
+#ifdef __linux__
+    // The cycle counter leads a group so every event covers the same
+    // stretch; the others are optional members
+    fds_[0] = OpenEvent(kEventConfigs[0], -1);
+    if (fds_[0] < 0) {
+        error_ = std::string("perf_event_open: ") + std::strerror(errno);
+        return;
+    }
+
+    for (int event = 1; event < kPerfEventCount; ++event) {
+        fds_[event] = OpenEvent(kEventConfigs[event], fds_[0]);
+    }
+#else
+    error_ = "hardware counters are only read on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (const int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+void PerfCounters::Start() {
+#ifdef __linux__
+    if (Available()) {
+        ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+PerfSample PerfCounters::Stop() {
+    PerfSample sample;
+
+#ifdef __linux__
+    if (!Available()) {
+        return sample;
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    for (int event = 0; event < kPerfEventCount; ++event) {
+        // value, time enabled, time running
+        std::uint64_t values[3];
+        if (fds_[event] < 0 || read(fds_[event], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+
+        if (values[2] == 0) {
+            // never got onto the PMU
+            continue;
+        }
+        sample.counts[event] = (values[2] < values[1])
+                                   ? static_cast<std::uint64_t>(static_cast<double>(values[0]) *
+                                                                values[1] / values[2])
+                                   : values[0];
+        sample.available[event] = true;
+    }
+#endif
+
+    return sample;
+}
+}  // namespace Sudoku
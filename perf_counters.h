@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace Sudoku {
+
+// Hardware events PerfCounters can count
+enum class PerfEvent { kCycles, kInstructions, kBranchMisses, kL1DataMisses, kLastLevelMisses };
+
+const int kPerfEventCount = 5;
+
+// Returns a printable name for the event
+const char *PerfEventName(const PerfEvent event);
+
+// Counts of each event over a measured stretch. Events the CPU or kernel
+// couldn't count are left unavailable.
+struct PerfSample {
+    std::array<std::uint64_t, kPerfEventCount> counts{};
+    std::array<bool, kPerfEventCount> available{};
+
+    std::uint64_t operator[](const PerfEvent event) const {
+        return counts[static_cast<int>(event)];
+    }
+
+    bool Has(const PerfEvent event) const { return available[static_cast<int>(event)]; }
+};
+
+// Hardware performance counters of the calling thread, read through Linux
+// perf_event_open. Counting needs a PMU the kernel will share (not always
+// there in VMs and containers) and a low enough perf_event_paranoid; when
+// the counters can't be opened, Available() is false and Error() says why.
+// Counts are scaled up if the kernel had to multiplex the counters.
+class PerfCounters {
+   public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool Available() const { return fds_[0] >= 0; }
+    const std::string &Error() const { return error_; }
+
+    // Zeroes the counters and starts counting
+    void Start();
+
+    // Stops counting and returns the counts since Start
+    PerfSample Stop();
+
+   private:
+    std::array<int, kPerfEventCount> fds_;
+    std::string error_;
+};
+}  // namespace Sudoku
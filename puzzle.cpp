@@ -5,148 +5,172 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "trace.h"
+
 namespace Sudoku {
 
-PuzzleRow_t Puzzle::GetRow(const int row) const { return board_[row]; }
+namespace {
+// Converts a cell value to its character in the one-line representation.
+// Values that don't belong to the board are shown as '?'.
+template <int BoxSize>
+char ValueToChar(const int value) {
+    if (value == kUnassigned) {
+        return kUnassignedChar;
+    }
 
-PuzzleCol_t Puzzle::GetColumn(const int column) const {
-    PuzzleCol_t col{};
-    for (auto &row : board_) {
-        col.push_back(row[column]);
+    if (value < 1 || value > BoardGeometry<BoxSize>::kBoardSize) {
+        return '?';
     }
 
-    return col;
+    return kDigitChars[value - 1];
 }
 
-bool Puzzle::IsValid() const {
-    if (board_.size() != kBoardSize) {
-        return false;
+// Converts a character from the one-line representation into a cell value,
+// returning -1 if the character doesn't represent a value on this board.
+template <int BoxSize>
+int CharToValue(const char board_char) {
+    if (board_char == kUnassignedChar) {
+        return kUnassigned;
     }
 
-    for (auto &row : board_) {
-        if (row.size() != kBoardSize) {
-            return false;
-        }
-
-        for (auto &elem : row) {
-            if (elem >= kBoardSize) {
-                return false;
-            }
+    for (int value = 1; value <= BoardGeometry<BoxSize>::kBoardSize; ++value) {
+        if (kDigitChars[value - 1] == board_char) {
+            return value;
         }
     }
 
-    if (!IsLegal()) {
-        return false;
-    }
-
-    return Size() == kTotalBoardSize;
+    return -1;
 }
+}  // namespace
 
-bool Puzzle::IsLegal() const {
-    for (int row = 0; row < kBoardSize; ++row) {
-        for (int column = 0; column < kBoardSize; ++column) {
-            if (!IsValidAssignment({row, column}, GetRow(row)[column])) {
-                return false;
-            }
-        }
+template <int BoxSize>
+PuzzleRow_t BasicPuzzle<BoxSize>::GetRow(const int row) const {
+    const auto &cells = Geometry::kUnits[row];
+    PuzzleRow_t puzzle_row(Geometry::kBoardSize);
+
+    for (int i = 0; i < Geometry::kBoardSize; ++i) {
+        puzzle_row[i] = cells_[cells[i]];
     }
 
-    return true;
+    return puzzle_row;
 }
 
-bool Puzzle::IsValidAssignment(const PuzzleCoord_t &coordinate, int value) const {
-    int row = coordinate.first;
-    int column = coordinate.second;
+template <int BoxSize>
+PuzzleCol_t BasicPuzzle<BoxSize>::GetColumn(const int column) const {
+    const auto &cells = Geometry::kUnits[Geometry::kBoardSize + column];
+    PuzzleCol_t col(Geometry::kBoardSize);
 
-    if (value == kUnassigned || GetRow(row)[column] == kUnassigned) {
-        return true;
+    for (int i = 0; i < Geometry::kBoardSize; ++i) {
+        col[i] = cells_[cells[i]];
     }
 
-    return IsValidRowAssignment(row, column, value) &&
-           IsValidColumnAssignment(row, column, value) && IsValidBoxAssignment(row, column, value);
+    return col;
 }
 
-bool Puzzle::IsValidRowAssignment(const int row, const int column, const int value) const {
-    PuzzleRow_t puzzle_row = GetRow(row);
-
-    // Since it has the given value, remove this cell before the check.
-    puzzle_row[column] = kUnassigned;
+template <int BoxSize>
+void BasicPuzzle<BoxSize>::Set(const int row, const int column, const int value) {
+    if (value < kUnassigned || value > Geometry::kBoardSize) {
+        throw std::invalid_argument("Value must be between 1 and " +
+                                    std::to_string(Geometry::kBoardSize) +
+                                    ". Inputted value: " + std::to_string(value));
+    }
 
-    // check row for value
-    return std::find(puzzle_row.begin(), puzzle_row.end(), value) == puzzle_row.end();
+    Assign(row * Geometry::kBoardSize + column, value);
 }
 
-bool Puzzle::IsValidColumnAssignment(const int row, const int column, const int value) const {
-    PuzzleCol_t puzzle_column = GetColumn(column);
+template <int BoxSize>
+void BasicPuzzle<BoxSize>::Clear(const int row, const int column) {
+    Unassign(row * Geometry::kBoardSize + column);
+}
 
-    // Since it has the given value, remove this cell before the check.
-    puzzle_column[row] = kUnassigned;
+template <int BoxSize>
+void BasicPuzzle<BoxSize>::Ingest(const Cells_t &cells) {
+    // assigning the givens is what finds their conflicts for IsValid
+    SUDOKU_TRACE_SCOPE("validate");
 
-    // check column for value
-    return std::find(puzzle_column.begin(), puzzle_column.end(), value) == puzzle_column.end();
+    cells_.fill(kUnassigned);
+    for (auto &unit : unit_counts_) {
+        unit.fill(0);
+    }
+    unit_masks_.fill(0);
+    conflict_count_ = 0;
+    filled_count_ = 0;
+    hash_ = 0;
+    trail_.clear();
+    checkpoints_.clear();
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (cells[cell] != kUnassigned) {
+            Assign(cell, cells[cell]);
+        }
+    }
 }
 
-bool Puzzle::IsValidBoxAssignment(const int row, const int column, const int value) const {
-    int box_row_offset = (row / kBoardSquareSize) * kBoardSquareSize;
-    int box_column_offset = (column / kBoardSquareSize) * kBoardSquareSize;
+template <int BoxSize>
+bool BasicPuzzle<BoxSize>::IsValidAssignment(const PuzzleCoord_t &coordinate,
+                                             const int value) const {
+    int row = coordinate.first;
+    int column = coordinate.second;
 
-    for (int i = box_row_offset; i < kBoardSquareSize + box_row_offset; ++i) {
-        for (int j = box_column_offset; j < kBoardSquareSize + box_column_offset; ++j) {
-            if ((i == row) && (j == column)) {
-                continue;
-            }
+    if (value == kUnassigned) {
+        return true;
+    }
 
-            if (GetRow(i)[j] == value) {
-                return false;
-            }
-        }
+    if (value < kUnassigned || value > Geometry::kBoardSize) {
+        return false;
     }
 
-    return true;
+    int cell = row * Geometry::kBoardSize + column;
+
+    // The cell being assigned doesn't conflict with itself
+    int own_count = (cells_[cell] == value) ? 1 : 0;
+
+    return unit_counts_[Geometry::kRowOf[cell]][value] == own_count &&
+           unit_counts_[Geometry::kBoardSize + Geometry::kColumnOf[cell]][value] == own_count &&
+           unit_counts_[2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]][value] == own_count;
 }
 
-PuzzleCoord_t Puzzle::FindUnassignedPosition() const {
-    int row, col;
-    for (row = 0; row < 10; ++row) {
-        for (col = 0; col < 10; ++col) {
-            if (GetRow(row)[col] == 0) {
-                return PuzzleCoord_t{row, col};
-            }
+template <int BoxSize>
+PuzzleCoord_t BasicPuzzle<BoxSize>::FindUnassignedPosition() const {
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (cells_[cell] == kUnassigned) {
+            return PuzzleCoord_t{Geometry::kRowOf[cell], Geometry::kColumnOf[cell]};
         }
     }
 
     // could not find position
-    return PuzzleCoord_t{-1, 1};
+    return PuzzleCoord_t{-1, -1};
 }
 
-int Puzzle::Size() const {
-    int count = 0;
-    for (auto &row : board_) {
-        count += row.size();
-    }
-
-    return count;
+template <int BoxSize>
+int BasicPuzzle<BoxSize>::Size() const {
+    return Geometry::kTotalBoardSize;
 }
 
-std::string Puzzle::ToString() const {
-    std::string output;
-    for (auto &row : board_) {
-        for (auto &elem : row) {
-            output += (elem == kUnassigned) ? "_" : std::to_string(elem);
-        }
+template <int BoxSize>
+std::string BasicPuzzle<BoxSize>::ToString() const {
+    SUDOKU_TRACE_SCOPE("output");
+    std::string output(Geometry::kTotalBoardSize, kUnassignedChar);
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        output[cell] = ValueToChar<BoxSize>(cells_[cell]);
     }
 
     return output;
 }
 
-std::ostream &operator<<(std::ostream &out, const Puzzle &puzzle) {
-    for (int row = 0; row < kBoardSize; ++row) {
-        for (int col = 0; col < kBoardSize; ++col) {
-            out << ((puzzle.board_[row][col] == kUnassigned)
-                        ? " "
-                        : std::to_string(puzzle.board_[row][col]));
+template <int B>
+std::ostream &operator<<(std::ostream &out, const BasicPuzzle<B> &puzzle) {
+    using Geometry = BoardGeometry<B>;
+    SUDOKU_TRACE_SCOPE("output");
+
+    for (int row = 0; row < Geometry::kBoardSize; ++row) {
+        for (int col = 0; col < Geometry::kBoardSize; ++col) {
+            int value = puzzle.Get(row, col);
+            out << ((value == kUnassigned) ? ' ' : ValueToChar<B>(value));
 
-            if (((col % kBoardSquareSize) == kBoardSquareSize) && (col < kBoardSize - 1)) {
+            if (((col % Geometry::kBoxSize) == Geometry::kBoxSize - 1) &&
+                (col < Geometry::kBoardSize - 1)) {
                 // print vertical column
                 out << "|";
             }
@@ -154,53 +178,76 @@ std::ostream &operator<<(std::ostream &out, const Puzzle &puzzle) {
 
         out << std::endl;
 
-        if (((row % kBoardSquareSize) == kBoardSquareSize - 1) && (row < kBoardSize - 1)) {
+        if ((row % Geometry::kBoxSize) == Geometry::kBoxSize - 1) {
             // print horizontal row
-            out << std::string(kBoardSize + kBoardSquareSize, '-') << std::endl;
+            out << std::string(Geometry::kBoardSize + Geometry::kBoxSize - 1, '-') << std::endl;
         }
     }
 
     return out;
 }
 
-std::istream &operator>>(std::istream &in, Puzzle &puzzle) {
+template <int B>
+std::istream &operator>>(std::istream &in, BasicPuzzle<B> &puzzle) {
     std::string input;
     std::getline(in, input);
 
-    puzzle.board_ = Puzzle::BuildBoardVector(input);
+    puzzle.Ingest(BasicPuzzle<B>::ParseCells(input.data(), input.size()));
 
     return in;
 }
 
-PuzzleRow_t &Puzzle::operator[](const int row) { return board_[row]; }
+template <int BoxSize>
+PuzzleBoard_t BasicPuzzle<BoxSize>::BuildBoardVector(const std::string board_string) {
+    Cells_t cells = ParseCells(board_string.data(), board_string.size());
+    PuzzleBoard_t board_vector(Geometry::kBoardSize);
 
-PuzzleBoard_t Puzzle::BuildBoardVector(const std::string board_string) {
-    if (board_string.length() != kTotalBoardSize) {
+    for (int row = 0; row < Geometry::kBoardSize; ++row) {
+        board_vector[row].assign(cells.begin() + row * Geometry::kBoardSize,
+                                 cells.begin() + (row + 1) * Geometry::kBoardSize);
+    }
+
+    return board_vector;
+}
+
+template <int BoxSize>
+typename BasicPuzzle<BoxSize>::Cells_t BasicPuzzle<BoxSize>::ParseCells(
+    const char *board, const std::size_t length) {
+    SUDOKU_TRACE_SCOPE("parse");
+
+    if (length != Geometry::kTotalBoardSize) {
         throw std::invalid_argument(
-            "Board string must contain " + std::to_string(kTotalBoardSize) +
-            " characters. Inputted string's size: " + std::to_string(board_string.length()));
-    }
-
-    PuzzleBoard_t board_vector(kBoardSize);
-
-    for (int row = 0; row < kBoardSize; ++row) {
-        for (int col = 0; col < kBoardSize; ++col) {
-            int string_index = row * kBoardSize + col;
-            char board_char = board_string[string_index];
-
-            if (board_char == kUnassignedChar) {
-                board_vector[row].emplace_back(kUnassigned);
-            } else if (board_char >= '0' && board_char <= '9') {
-                // convert char to number
-                board_vector[row].emplace_back(board_char + '0');
-            } else {
-                throw std::invalid_argument(
-                    "Board string must only contain 1-9 and _. Invalid character: " +
-                    std::to_string(board_char));
-            }
+            "Board string must contain " + std::to_string(Geometry::kTotalBoardSize) +
+            " characters. Inputted string's size: " + std::to_string(length));
+    }
+
+    Cells_t cells{};
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        char board_char = board[cell];
+        int value = CharToValue<BoxSize>(board_char);
+
+        if (value < 0) {
+            throw std::invalid_argument(std::string("Board string must only contain 1-") +
+                                        kDigitChars[Geometry::kBoardSize - 1] +
+                                        " and _. Invalid character: " + board_char);
         }
+
+        cells[cell] = static_cast<std::uint8_t>(value);
     }
 
-    return board_vector;
+    return cells;
 }
-}  // namespace Sudoku
\ No newline at end of file
+
+template class BasicPuzzle<3>;
+template class BasicPuzzle<4>;
+template class BasicPuzzle<5>;
+
+template std::ostream &operator<<(std::ostream &out, const BasicPuzzle<3> &puzzle);
+template std::ostream &operator<<(std::ostream &out, const BasicPuzzle<4> &puzzle);
+template std::ostream &operator<<(std::ostream &out, const BasicPuzzle<5> &puzzle);
+
+template std::istream &operator>>(std::istream &in, BasicPuzzle<3> &puzzle);
+template std::istream &operator>>(std::istream &in, BasicPuzzle<4> &puzzle);
+template std::istream &operator>>(std::istream &in, BasicPuzzle<5> &puzzle);
+}  // namespace Sudoku
@@ -1,8 +1,16 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
+#include "arena.h"
+#include "candidates.h"
+#include "geometry.h"
+
 namespace Sudoku {
 
 using PuzzleRow_t = std::vector<int>;
@@ -17,23 +25,170 @@ const int kTotalBoardSize = kBoardSize * kBoardSize;
 const int kUnassigned = 0;
 const char kUnassignedChar = '_';
 
+// Characters used for the values 1..25 in the one-line board representation.
+// 9x9 boards only ever use '1'-'9'; 16x16 and 25x25 boards continue with letters.
+const char kDigitChars[] = "123456789ABCDEFGHIJKLMNOP";
+
 // Class representing the state of a single Sudoku puzzle to be solved.
-// We represent the board as a vector of vectors of int values, where 0
-// represents no assigned value, and 1-9 represent value assignments
-class Puzzle {
+// We represent the board as a flat row-major array of cell values, where 0
+// represents no assigned value, and 1-N represent value assignments for a
+// board with N = BoxSize * BoxSize rows.
+//
+// Alongside the board we keep per-unit value counts and masks, the number of
+// conflicting values, the number of filled cells and a Zobrist hash of the
+// board. Every mutation goes through Assign/Unassign, which keep all of these
+// up to date in O(1), so legality and completeness checks never rescan the
+// board; only ingesting a new board string does.
+//
+// Search engines backtrack with Checkpoint/Rollback: while a checkpoint is
+// open, each mutation records the cell's previous value on a trail, and
+// rolling back replays the trail in O(changes) instead of copying the board.
+template <int BoxSize>
+class BasicPuzzle {
    public:
+    using Geometry = BoardGeometry<BoxSize>;
+    using Mask_t = typename Geometry::Mask_t;
+
     // Default constructor builds an empty board
-    Puzzle() : Puzzle(std::string(kTotalBoardSize, kUnassignedChar)) {}
+    BasicPuzzle() { Ingest(Cells_t{}); }
 
-    // Main constructor takes in the string representation of the sudoku puzzle
-    Puzzle(const std::string board_string) : board_(BuildBoardVector(board_string)) {}
+    // Main constructor takes in the string representation of the sudoku puzzle.
+    // Neither constructor touches the heap, so parsing a stream of puzzles into
+    // existing storage doesn't allocate.
+    BasicPuzzle(const std::string &board_string)
+        : BasicPuzzle(board_string.data(), board_string.size()) {}
+
+    // Same, from the characters of a larger buffer, such as one line of a
+    // request read off a socket
+    BasicPuzzle(const char *board, const std::size_t length) { Ingest(ParseCells(board, length)); }
 
     PuzzleRow_t GetRow(const int row) const;
     PuzzleCol_t GetColumn(const int column) const;
 
-    // Tests that the puzzle is of the correct dimensions, and ensures that it
-    // contains only valid values (ie 1-9)
-    bool IsValid() const;
+    // Returns the value at the given location without copying the row
+    int Get(const int row, const int column) const {
+        return cells_[row * Geometry::kBoardSize + column];
+    }
+
+    // Returns the value of a cell by its row-major index
+    int GetCell(const int cell) const { return cells_[cell]; }
+
+    // Returns the values that no peer of the cell currently holds
+    Mask_t Candidates(const int cell) const {
+        return static_cast<Mask_t>(
+            Geometry::kAllValues &
+            ~(unit_masks_[Geometry::kRowOf[cell]] |
+              unit_masks_[Geometry::kBoardSize + Geometry::kColumnOf[cell]] |
+              unit_masks_[2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]]));
+    }
+
+    // Fills in the candidates of every cell at once, using the fastest
+    // candidate kernel this CPU supports
+    void AllCandidates(CandidateTable<BoxSize> &table) const {
+        ComputeCandidates<BoxSize>(cells_.data(), unit_masks_.data(), table);
+    }
+
+    // Assigns a value (1-N) to a cell, replacing whatever was there. Values
+    // outside the board are not checked here; use Set for checked writes.
+    void Assign(const int cell, const int value) {
+        const int previous = cells_[cell];
+        if (!checkpoints_.empty()) {
+            trail_.push_back({static_cast<typename Geometry::Cell_t>(cell),
+                              static_cast<std::uint8_t>(previous)});
+        }
+
+        if (previous != kUnassigned) {
+            RemoveValue(cell, previous);
+        }
+
+        cells_[cell] = static_cast<std::uint8_t>(value);
+
+        if (value != kUnassigned) {
+            AddValue(cell, value);
+        }
+    }
+
+    // Clears a cell back to kUnassigned
+    void Unassign(const int cell) { Assign(cell, kUnassigned); }
+
+    // Opens a checkpoint. Checkpoints nest; each Rollback or Commit closes the
+    // most recent one.
+    void Checkpoint() { checkpoints_.push_back(trail_.size()); }
+
+    // Undoes every mutation made since the most recent checkpoint and closes it
+    void Rollback() {
+        const std::size_t mark = checkpoints_.back();
+        checkpoints_.pop_back();
+
+        while (trail_.size() > mark) {
+            const TrailEntry entry = trail_.back();
+            trail_.pop_back();
+
+            const int current = cells_[entry.cell];
+            if (current != kUnassigned) {
+                RemoveValue(entry.cell, current);
+            }
+
+            cells_[entry.cell] = entry.previous_value;
+
+            if (entry.previous_value != kUnassigned) {
+                AddValue(entry.cell, entry.previous_value);
+            }
+        }
+    }
+
+    // Returns true if any checkpoint is open
+    bool HasCheckpoint() const { return !checkpoints_.empty(); }
+
+    // Moves the (empty) undo trail into the given arena, or back onto the heap
+    // for nullptr, so a search can checkpoint without touching the heap.
+    // Returns false and leaves the trail alone if a checkpoint is open.
+    bool AttachArena(Arena *arena) {
+        if (HasCheckpoint()) {
+            return false;
+        }
+
+        trail_ = Trail_t(ArenaAllocator<TrailEntry>(arena));
+        checkpoints_ = Checkpoints_t(ArenaAllocator<std::size_t>(arena));
+
+        if (arena != nullptr) {
+            trail_.reserve(Geometry::kTotalBoardSize);
+            checkpoints_.reserve(Geometry::kTotalBoardSize);
+        }
+
+        return true;
+    }
+
+    // Keeps every mutation made since the most recent checkpoint and closes it.
+    // The changes become part of the enclosing checkpoint, if there is one.
+    void Commit() {
+        checkpoints_.pop_back();
+        if (checkpoints_.empty()) {
+            trail_.clear();
+        }
+    }
+
+    // Assigns a value (1-N, or kUnassigned to clear) to the given location.
+    // Throws std::invalid_argument for values outside the board.
+    void Set(const int row, const int column, const int value);
+
+    // Clears the given location back to kUnassigned
+    void Clear(const int row, const int column);
+
+    // Tests that the puzzle contains only valid values (ie 1-9) with no two
+    // equal values sharing a row, column or box. O(1).
+    bool IsValid() const { return conflict_count_ == 0; }
+
+    // Returns true if every cell is filled and the board is valid. O(1).
+    bool IsComplete() const {
+        return IsValid() && filled_count_ == Geometry::kTotalBoardSize;
+    }
+
+    // Returns the number of assigned cells
+    int FilledCount() const { return filled_count_; }
+
+    // Zobrist hash of the current board, maintained incrementally
+    std::uint64_t Hash() const { return hash_; }
 
     // Given a puzzle, location, and value, checks to see whether or not the value
     // is a valid assignment for the board.
@@ -51,28 +206,115 @@ class Puzzle {
     std::string ToString() const;
 
     // Overloaded output operator for pretty printing the puzzle
-    friend std::ostream &operator<<(std::ostream &out, const Puzzle &puzzle);
+    template <int B>
+    friend std::ostream &operator<<(std::ostream &out, const BasicPuzzle<B> &puzzle);
 
     // Overloaded input operator for loading the puzzle from a stream
     // expects the stream to contain a line containing only a sudoku puzzle
-    friend std::istream &operator>>(std::istream &in, Puzzle &puzzle);
+    template <int B>
+    friend std::istream &operator>>(std::istream &in, BasicPuzzle<B> &puzzle);
 
-    // Convenience operator to allow accessing a row by reference instead of
-    // value.
-    PuzzleRow_t &operator[](const int row);
+    // Convenience operator for read-only puzzle[row][column] access. Rows
+    // can't be written or resized through it; mutate the board through
+    // Assign/Set so the bookkeeping stays consistent.
+    const std::uint8_t *operator[](const int row) const {
+        return cells_.data() + row * Geometry::kBoardSize;
+    }
 
     // Helper method to build up a 2D vector representation of a sudoku board
     static PuzzleBoard_t BuildBoardVector(const std::string board_string);
 
    private:
-    PuzzleBoard_t board_;
+    // Cell values, followed by kCandidatePadding always-empty bytes so the
+    // vector candidate kernels can load whole rows
+    using Cells_t = std::array<std::uint8_t, Geometry::kTotalBoardSize + kCandidatePadding>;
+    using UnitCounts_t = std::array<std::array<std::uint8_t, Geometry::kBoardSize + 1>,
+                                    Geometry::kUnitCount>;
+
+    struct TrailEntry {
+        typename Geometry::Cell_t cell;
+        std::uint8_t previous_value;
+    };
+
+    using Trail_t = ArenaVector<TrailEntry>;
+    using Checkpoints_t = ArenaVector<std::size_t>;
 
-    bool IsLegal() const;
+    Cells_t cells_{};
 
-    bool IsValidRowAssignment(const int row, const int column, const int value) const;
+    // Incremental bookkeeping, indexed by unit (rows, then columns, then boxes)
+    UnitCounts_t unit_counts_{};
+    std::array<Mask_t, Geometry::kUnitCount + kUnitMaskPadding> unit_masks_{};
+    int conflict_count_ = 0;
+    int filled_count_ = 0;
+    std::uint64_t hash_ = 0;
 
-    bool IsValidColumnAssignment(const int row, const int column, const int value) const;
+    // Undo trail and the trail length at each open checkpoint
+    Trail_t trail_;
+    Checkpoints_t checkpoints_;
 
-    bool IsValidBoxAssignment(const int row, const int column, const int value) const;
+    // Parses and checks a board string, throwing std::invalid_argument if it
+    // has the wrong length or contains characters that aren't values.
+    static Cells_t ParseCells(const char *board, const std::size_t length);
+
+    // Replaces the board, rebuilding the bookkeeping from scratch and
+    // dropping any open checkpoints.
+    void Ingest(const Cells_t &cells);
+
+    // Updates the bookkeeping for a value entering or leaving a cell
+    void AddValue(const int cell, const int value) {
+        ++filled_count_;
+        hash_ ^= ZobristKey(cell, value);
+
+        const Mask_t bit = Geometry::ValueBit(value);
+        for (int unit : {static_cast<int>(Geometry::kRowOf[cell]),
+                         Geometry::kBoardSize + Geometry::kColumnOf[cell],
+                         2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]}) {
+            // every copy of a value beyond the first in a unit is a conflict
+            if (unit_counts_[unit][value]++ > 0) {
+                ++conflict_count_;
+            }
+            unit_masks_[unit] |= bit;
+        }
+    }
+
+    void RemoveValue(const int cell, const int value) {
+        --filled_count_;
+        hash_ ^= ZobristKey(cell, value);
+
+        const Mask_t bit = Geometry::ValueBit(value);
+        for (int unit : {static_cast<int>(Geometry::kRowOf[cell]),
+                         Geometry::kBoardSize + Geometry::kColumnOf[cell],
+                         2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]}) {
+            if (--unit_counts_[unit][value] > 0) {
+                --conflict_count_;
+            } else {
+                unit_masks_[unit] &= static_cast<Mask_t>(~bit);
+            }
+        }
+    }
+
+    // Hash contribution of a value in a cell (splitmix64 of the pair)
+    static constexpr std::uint64_t ZobristKey(const int cell, const int value) {
+        std::uint64_t key = (static_cast<std::uint64_t>(cell) << 5 | value) + 0x9E3779B97F4A7C15ull;
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+        return key ^ (key >> 31);
+    }
 };
-}  // namespace Sudoku
\ No newline at end of file
+
+template <int B>
+std::ostream &operator<<(std::ostream &out, const BasicPuzzle<B> &puzzle);
+
+template <int B>
+std::istream &operator>>(std::istream &in, BasicPuzzle<B> &puzzle);
+
+// The classic 9x9 board, plus the larger boards we support.
+using Puzzle = BasicPuzzle<3>;
+using Puzzle16 = BasicPuzzle<4>;
+using Puzzle25 = BasicPuzzle<5>;
+
+// Instantiated in puzzle.cpp
+extern template class BasicPuzzle<3>;
+extern template class BasicPuzzle<4>;
+extern template class BasicPuzzle<5>;
+}  // namespace Sudoku
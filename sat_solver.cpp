@@ -0,0 +1,128 @@
+#include "sat_solver.h"
+
+#include "trace.h"
+
+namespace Sudoku {
+
+template <int BoxSize>
+bool BasicSatSolver<BoxSize>::Encode(const BasicPuzzle<BoxSize> &puzzle) {
+    const int kBoardSize = Geometry::kBoardSize;
+
+    core_.Reset();
+    variables_.assign(Geometry::kTotalBoardSize * kBoardSize, -1);
+
+    // Each empty cell takes one of its candidates, and at most one
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (puzzle.GetCell(cell) != kUnassigned) {
+            continue;
+        }
+
+        clause_.clear();
+        for (auto mask = puzzle.Candidates(cell); mask != 0; mask &= mask - 1) {
+            const int value = __builtin_ctz(mask);
+            const int variable = core_.NewVariable();
+            variables_[cell * kBoardSize + value] = variable;
+            clause_.push_back(CdclSolver::Positive(variable));
+        }
+
+        if (!core_.AddClause(clause_)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < clause_.size(); ++i) {
+            for (std::size_t j = i + 1; j < clause_.size(); ++j) {
+                core_.AddClause({clause_[i] ^ 1, clause_[j] ^ 1});
+            }
+        }
+    }
+
+    // Two peers never share a value
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        for (int value = 0; value < kBoardSize; ++value) {
+            const int variable = variables_[cell * kBoardSize + value];
+            if (variable < 0) {
+                continue;
+            }
+
+            for (const int peer : Geometry::kPeers[cell]) {
+                const int other = variables_[peer * kBoardSize + value];
+                if (peer > cell && other >= 0) {
+                    core_.AddClause(
+                        {CdclSolver::Negative(variable), CdclSolver::Negative(other)});
+                }
+            }
+        }
+    }
+
+    // Every value missing from a unit goes somewhere in it
+    for (int unit = 0; unit < Geometry::kUnitCount; ++unit) {
+        for (int value = 0; value < kBoardSize; ++value) {
+            bool placed = false;
+            clause_.clear();
+
+            for (const int cell : Geometry::kUnits[unit]) {
+                placed = placed || puzzle.GetCell(cell) == value + 1;
+                const int variable = variables_[cell * kBoardSize + value];
+                if (variable >= 0) {
+                    clause_.push_back(CdclSolver::Positive(variable));
+                }
+            }
+
+            if (!placed && !core_.AddClause(clause_)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <int BoxSize>
+bool BasicSatSolver<BoxSize>::SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) {
+    this->budget_exhausted_ = false;
+    {
+        // the encoding leaves out every value the givens rule out
+        SUDOKU_TRACE_SCOPE("propagate");
+        if (!puzzle.IsValid()) {
+            // forget the last puzzle's formula, so LastNodes() reports 0
+            core_.Reset();
+            return false;
+        }
+        if (!Encode(puzzle)) {
+            return false;
+        }
+    }
+
+    // the node limit is a conflict limit too; the tighter one wins
+    std::uint64_t limit = conflict_limit_;
+    if (this->node_limit_ != 0 && (limit == 0 || this->node_limit_ < limit)) {
+        limit = this->node_limit_;
+    }
+
+    CdclSolver::Result result;
+    {
+        SUDOKU_TRACE_SCOPE("search");
+        result = core_.Solve(limit);
+    }
+    if (result != CdclSolver::Result::kSatisfiable) {
+        this->budget_exhausted_ = (result == CdclSolver::Result::kUnknown);
+        return false;
+    }
+
+    const int kBoardSize = Geometry::kBoardSize;
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        for (int value = 0; value < kBoardSize; ++value) {
+            const int variable = variables_[cell * kBoardSize + value];
+            if (variable >= 0 && core_.ModelValue(variable)) {
+                puzzle.Assign(cell, value + 1);
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+template class BasicSatSolver<3>;
+template class BasicSatSolver<4>;
+template class BasicSatSolver<5>;
+}  // namespace Sudoku
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "cdcl.h"
+#include "engine.h"
+#include "puzzle.h"
+
+namespace Sudoku {
+
+// Solves puzzles by encoding them as CNF and running them through the
+// embedded CDCL solver (see CdclSolver). There is one variable per empty cell
+// and candidate value; clauses say every cell and every unit gets each missing
+// value exactly once. Givens and values ruled out by them never become
+// variables, which keeps the formula small on big, sparse boards where
+// backtracking stalls.
+//
+// Like the other engines a SatSolver keeps scratch state between puzzles and
+// must only be used by one thread at a time.
+template <int BoxSize>
+class BasicSatSolver : public BasicEngine<BoxSize> {
+   public:
+    using Geometry = BoardGeometry<BoxSize>;
+
+    const char *Name() const override { return "sat"; }
+
+    // Attempts to solve a single puzzle, and returns true if it was able to be
+    // solved. Gives up (returns false) once the conflict limit is reached.
+    bool SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) override;
+
+    // Number of conflicts after which a solve gives up; 0 means never
+    void SetConflictLimit(const std::uint64_t limit) { conflict_limit_ = limit; }
+
+    // Conflicts the CDCL core needed for the last puzzle
+    std::uint64_t LastConflicts() const { return core_.Conflicts(); }
+
+    std::uint64_t LastNodes() const override { return core_.Conflicts(); }
+
+   private:
+    CdclSolver core_;
+    std::uint64_t conflict_limit_ = 0;
+
+    // variables_[cell * N + value - 1], or -1 where the value isn't possible
+    std::vector<int> variables_;
+    std::vector<CdclSolver::Literal> clause_;
+
+    bool Encode(const BasicPuzzle<BoxSize> &puzzle);
+};
+
+using SatSolver = BasicSatSolver<3>;
+using SatSolver16 = BasicSatSolver<4>;
+using SatSolver25 = BasicSatSolver<5>;
+
+// Instantiated in sat_solver.cpp
+extern template class BasicSatSolver<3>;
+extern template class BasicSatSolver<4>;
+extern template class BasicSatSolver<5>;
+}  // namespace Sudoku
@@ -0,0 +1,131 @@
+#include "search_checkpoint.h"
+
+#include <sstream>
+#include <stdexcept>
+
+#include "geometry.h"
+
+namespace Sudoku {
+
+namespace {
+// Next line of a checkpoint, which must exist
+std::string ReadLine(std::istream &input, const std::string &what) {
+    std::string line;
+    if (!std::getline(input, line)) {
+        throw std::invalid_argument("Checkpoint ends before its " + what);
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return line;
+}
+
+// Reads a "key value" line and returns the value
+std::string ReadField(std::istream &input, const std::string &key) {
+    const std::string line = ReadLine(input, key);
+    if (line.compare(0, key.size() + 1, key + " ") != 0) {
+        throw std::invalid_argument("Checkpoint line \"" + line + "\" should start with " + key);
+    }
+    return line.substr(key.size() + 1);
+}
+
+std::uint64_t ParseNumber(const std::string &text, const std::string &what) {
+    std::istringstream stream(text);
+    std::uint64_t number;
+    if (!(stream >> number) || !(stream >> std::ws).eof()) {
+        throw std::invalid_argument("Checkpoint " + what + " isn't a number: " + text);
+    }
+    return number;
+}
+
+// Written before the search order was recorded
+const std::string kVersion1Header = "# sudoku-checkpoint 1";
+
+// Reads the header and returns the checkpoint's format version
+int ReadVersion(std::istream &input) {
+    const std::string header = ReadLine(input, "header");
+    if (header == kVersion1Header) {
+        return 1;
+    }
+    if (header != kCheckpointHeader) {
+        throw std::invalid_argument("Not a search checkpoint");
+    }
+    return 2;
+}
+
+int ReadBoxSize(std::istream &input) {
+    return static_cast<int>(ParseNumber(ReadField(input, "box"), "box size"));
+}
+}  // namespace
+
+int PeekCheckpointBoxSize(std::istream &input) {
+    const std::istream::pos_type start = input.tellg();
+    ReadVersion(input);
+    const int box_size = ReadBoxSize(input);
+    input.seekg(start);
+    return box_size;
+}
+
+template <int BoxSize>
+void BasicSearchCheckpoint<BoxSize>::Write(std::ostream &output) const {
+    output << kCheckpointHeader << '\n'
+           << "box " << BoxSize << '\n'
+           << "board " << board << '\n'
+           << "nodes " << nodes << '\n'
+           << "lexicographic " << (lexicographic ? 1 : 0) << '\n'
+           << "frames " << frames.size() << '\n';
+    for (const Frame &frame : frames) {
+        output << frame.cell << ' ' << frame.value << ' ' << frame.remaining << '\n';
+    }
+}
+
+template <int BoxSize>
+BasicSearchCheckpoint<BoxSize> BasicSearchCheckpoint<BoxSize>::Read(std::istream &input) {
+    using Geometry = BoardGeometry<BoxSize>;
+
+    const int version = ReadVersion(input);
+    const int box_size = ReadBoxSize(input);
+    if (box_size != BoxSize) {
+        throw std::invalid_argument("Checkpoint is for box size " + std::to_string(box_size) +
+                                    ", expected " + std::to_string(BoxSize));
+    }
+
+    BasicSearchCheckpoint checkpoint;
+    checkpoint.board = ReadField(input, "board");
+    checkpoint.nodes = ParseNumber(ReadField(input, "nodes"), "node count");
+    if (version >= 2) {
+        const std::uint64_t lexicographic =
+            ParseNumber(ReadField(input, "lexicographic"), "search order");
+        if (lexicographic > 1) {
+            throw std::invalid_argument("Checkpoint search order should be 0 or 1");
+        }
+        checkpoint.lexicographic = (lexicographic == 1);
+    }
+
+    const std::uint64_t frame_count = ParseNumber(ReadField(input, "frames"), "frame count");
+    if (frame_count > static_cast<std::uint64_t>(Geometry::kTotalBoardSize)) {
+        throw std::invalid_argument("Checkpoint has more frames than cells");
+    }
+
+    for (std::uint64_t i = 0; i < frame_count; ++i) {
+        const std::string line = ReadLine(input, "frames");
+        std::istringstream fields(line);
+        Frame frame;
+        if (!(fields >> frame.cell >> frame.value >> frame.remaining) ||
+            !(fields >> std::ws).eof()) {
+            throw std::invalid_argument("Bad checkpoint frame: " + line);
+        }
+        if (frame.cell < 0 || frame.cell >= Geometry::kTotalBoardSize || frame.value < 1 ||
+            frame.value > Geometry::kBoardSize || (frame.remaining & ~Geometry::kAllValues) != 0) {
+            throw std::invalid_argument("Checkpoint frame out of range: " + line);
+        }
+        checkpoint.frames.push_back(frame);
+    }
+
+    return checkpoint;
+}
+
+template struct BasicSearchCheckpoint<3>;
+template struct BasicSearchCheckpoint<4>;
+template struct BasicSearchCheckpoint<5>;
+}  // namespace Sudoku
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Sudoku {
+
+// Snapshot of the backtracking solver part way through a puzzle, enough to
+// pick the search up again later, in another process or on another machine:
+// the board as given, the nodes searched so far, the order cells are branched
+// on (see BasicEngine::SetLexicographic) and the search stack. The
+// puzzle's undo trail isn't stored; resuming rebuilds it by applying each
+// frame's value in order.
+//
+// Checkpoints are written as text, one field per line:
+//
+//   # sudoku-checkpoint 2
+//   box 3
+//   board ___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______6___
+//   nodes 1234
+//   lexicographic 0
+//   frames 2
+//   0 4 160
+//   1 2 0
+//
+// where each frame line is a cell, the value applied there and the mask of
+// values still to try there. Version 1 checkpoints, which have no
+// lexicographic line, are read as searches in the default order.
+template <int BoxSize>
+struct BasicSearchCheckpoint {
+    struct Frame {
+        int cell;
+        int value;
+        std::uint32_t remaining;
+    };
+
+    std::string board;
+    std::uint64_t nodes = 0;
+    bool lexicographic = false;
+    std::vector<Frame> frames;
+
+    void Write(std::ostream &output) const;
+
+    // Reads a checkpoint written by Write. Throws std::invalid_argument if the
+    // input isn't one, or was written for another board size.
+    static BasicSearchCheckpoint Read(std::istream &input);
+};
+
+using SearchCheckpoint = BasicSearchCheckpoint<3>;
+using SearchCheckpoint16 = BasicSearchCheckpoint<4>;
+using SearchCheckpoint25 = BasicSearchCheckpoint<5>;
+
+const std::string kCheckpointHeader = "# sudoku-checkpoint 2";
+
+// Box size a checkpoint was written for, read from its header without
+// consuming the stream. Throws std::invalid_argument if it has none.
+int PeekCheckpointBoxSize(std::istream &input);
+
+// Instantiated in search_checkpoint.cpp
+extern template struct BasicSearchCheckpoint<3>;
+extern template struct BasicSearchCheckpoint<4>;
+extern template struct BasicSearchCheckpoint<5>;
+}  // namespace Sudoku
@@ -0,0 +1,723 @@
+#include "server.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+#include "puzzle.h"
+
+namespace Sudoku {
+
+namespace {
+// Replies a connection may have waiting to be written before the server stops
+// reading its requests, so a client that never reads can't grow them either
+const std::size_t kMaxPendingOutput = 1 << 20;
+
+// Most replies handed to one gather write
+const int kMaxWriteBuffers = 64;
+
+// Most events taken from one epoll_wait
+const int kMaxEvents = 64;
+
+// Quantiles of the solve time reported next to the histogram
+const double kLatencyQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+// Histogram buckets: every power of four from 256ns to about 17s, and from 0
+// to about a million search nodes
+std::vector<std::uint64_t> PowersOfFour(const std::uint64_t first, const int count) {
+    std::vector<std::uint64_t> bounds;
+    for (int i = 0; i < count; ++i) {
+        bounds.push_back(first << (2 * i));
+    }
+
+    return bounds;
+}
+
+const std::vector<std::uint64_t> kLatencyBounds = PowersOfFour(256, 14);
+const std::vector<std::uint64_t> kNodeBounds = [] {
+    std::vector<std::uint64_t> bounds = PowersOfFour(1, 11);
+    bounds.insert(bounds.begin(), 0);
+    return bounds;
+}();
+
+void Control(const int epoll_fd, const int operation, const int fd, const std::uint32_t events) {
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+
+    if (epoll_ctl(epoll_fd, operation, fd, &event) < 0) {
+        throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+    }
+}
+}  // namespace
+
+void LineReader::Append(const char *data, std::size_t size) {
+    if (skipping_) {
+        // the rest of a line already handed out as too long
+        const void *newline = std::memchr(data, '\n', size);
+        if (newline == nullptr) {
+            return;
+        }
+        skipping_ = false;
+        const std::size_t skipped = static_cast<const char *>(newline) + 1 - data;
+        data += skipped;
+        size -= skipped;
+    }
+
+    input_.append(data, size);
+}
+
+void LineReader::TakeLines(std::vector<LineRange> &lines) {
+    // Only the bytes that arrived since the last call need scanning
+    std::size_t newline;
+    while ((newline = input_.find('\n', scanned_)) != std::string::npos) {
+        std::size_t end = newline;
+        if (end > line_start_ && input_[end - 1] == '\r') {
+            --end;
+        }
+
+        lines.push_back({line_start_, end - line_start_});
+        line_start_ = newline + 1;
+        scanned_ = line_start_;
+    }
+    scanned_ = input_.size();
+
+    if (input_.size() - line_start_ > kMaxLineLength) {
+        lines.push_back({line_start_, kMaxLineLength + 1});
+        input_.resize(line_start_ + kMaxLineLength + 1);
+        line_start_ = input_.size();
+        scanned_ = line_start_;
+        skipping_ = true;
+    }
+}
+
+void LineReader::Consume() {
+    input_.erase(0, line_start_);
+    scanned_ -= line_start_;
+    line_start_ = 0;
+}
+
+bool ParseRequest(const char *line, const std::size_t length, Puzzle &puzzle) {
+    if (length == 0 || line[0] == '#') {
+        return false;
+    }
+    if (length > kMaxLineLength) {
+        throw std::invalid_argument("line too long");
+    }
+
+    puzzle = Puzzle(line, length);
+    return true;
+}
+
+Server::Server(const ServerOptions &options)
+    : options_(options),
+      cache_(options.cache_size),
+      batcher_(options.engine, options.threads, options.batch),
+      started_(std::chrono::steady_clock::now()),
+      last_metrics_(started_) {}
+
+Server::~Server() {
+    Stop();
+
+    for (auto &entry : connections_) {
+        close(entry.first);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        close(epoll_fd_);
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(options_.socket_path.c_str());
+    }
+}
+
+void Server::Listen() {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (options_.socket_path.empty() || options_.socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + options_.socket_path);
+    }
+    std::strcpy(address.sun_path, options_.socket_path.c_str());
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+
+    // a socket file left behind by an earlier run would make bind fail
+    unlink(options_.socket_path.c_str());
+
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        throw std::system_error(errno, std::generic_category(), "bind");
+    }
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        throw std::system_error(errno, std::generic_category(), "listen");
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "epoll_create1");
+    }
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+    }
+
+    Control(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+    accepting_ = true;
+    Control(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, EPOLLIN);
+}
+
+void Server::Run() {
+    epoll_event events[kMaxEvents];
+    bool draining = false;
+    auto next_dump = std::chrono::steady_clock::now() + options_.metrics_interval;
+
+    while (true) {
+        if (stopping_ && !draining) {
+            // Stop taking requests, but answer everything already read
+            draining = true;
+            if (accepting_) {
+                Control(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, 0);
+                accepting_ = false;
+            }
+
+            for (auto it = connections_.begin(); it != connections_.end();) {
+                Connection &connection = *(it++)->second;
+                connection.read_closed = true;
+                if (!CloseIfDone(connection)) {
+                    Watch(connection);
+                }
+            }
+        }
+        if (draining && pending_groups_ == 0) {
+            break;
+        }
+
+        // wake up in time for the next metrics dump
+        int timeout = -1;
+        if (!options_.metrics_path.empty()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_dump) {
+                DumpMetrics();
+                next_dump = now + options_.metrics_interval;
+            }
+            timeout = static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(next_dump - now).count() +
+                1);
+        }
+
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, timeout);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "epoll_wait");
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                Accept();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                std::uint64_t wakes;
+                while (read(wake_fd_, &wakes, sizeof(wakes)) > 0) {
+                }
+                CollectFinished();
+                continue;
+            }
+
+            // the connection may have been closed by an earlier event
+            auto found = connections_.find(fd);
+            if (found == connections_.end()) {
+                continue;
+            }
+            Connection &connection = *found->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                connection.read_closed = true;
+                connection.failed = true;
+            } else {
+                if (events[i].events & EPOLLIN) {
+                    Read(connection);
+                }
+                if (events[i].events & EPOLLOUT) {
+                    Flush(connection);
+                }
+            }
+
+            if (!CloseIfDone(connection)) {
+                Watch(connection);
+            }
+        }
+    }
+
+    // every group is answered; send what the sockets will take and hang up
+    for (auto &entry : connections_) {
+        Flush(*entry.second);
+        close(entry.first);
+    }
+    connections_.clear();
+    connection_count_ = 0;
+
+    if (!options_.metrics_path.empty()) {
+        DumpMetrics();
+    }
+}
+
+void Server::Stop() {
+    stopping_ = true;
+    Wake();
+}
+
+void Server::Wake() {
+    if (wake_fd_ >= 0) {
+        const std::uint64_t one = 1;
+        ssize_t result = write(wake_fd_, &one, sizeof(one));
+        (void)result;
+    }
+}
+
+void Server::WriteMetrics(std::string &text) {
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    const double interval = std::chrono::duration<double>(now - last_metrics_).count();
+    last_metrics_ = now;
+
+    struct Source {
+        std::string labels;
+        EngineMetrics::Totals totals;
+    };
+    std::vector<Source> sources;
+    sources.push_back(Source{"engine=\"" + batcher_.Metrics().Engine() + "\",path=\"batch\"",
+                             batcher_.Metrics().Collect()});
+    if (batcher_.DegradeMetrics() != nullptr) {
+        sources.push_back(
+            Source{"engine=\"" + batcher_.DegradeMetrics()->Engine() + "\",path=\"degrade\"",
+                   batcher_.DegradeMetrics()->Collect()});
+    }
+
+    MetricsText page;
+    page.Family("sudoku_uptime_seconds", "gauge", "Seconds since the server started.");
+    page.Sample("sudoku_uptime_seconds", "", std::chrono::duration<double>(now - started_).count());
+
+    page.Family("sudoku_solves_total", "counter",
+                "Puzzles run through an engine, by engine, path (batch or degrade) and result.");
+    for (const auto &source : sources) {
+        const EngineMetrics::Totals &totals = source.totals;
+        page.Sample("sudoku_solves_total", source.labels + ",result=\"solved\"", totals.solved);
+        page.Sample("sudoku_solves_total", source.labels + ",result=\"unsolved\"",
+                    totals.unsolved - totals.gave_up);
+        page.Sample("sudoku_solves_total", source.labels + ",result=\"gave_up\"", totals.gave_up);
+    }
+
+    page.Family("sudoku_solves_per_second", "gauge",
+                "Puzzles run through an engine per second since the previous scrape.");
+    for (const auto &source : sources) {
+        const std::uint64_t total = source.totals.solved + source.totals.unsolved;
+        std::uint64_t &last = last_solves_[source.labels];
+        page.Sample("sudoku_solves_per_second", source.labels,
+                    interval > 0 ? (total - last) / interval : 0.0);
+        last = total;
+    }
+
+    page.Family("sudoku_solve_duration_seconds", "histogram", "Time taken to solve a puzzle.");
+    for (const auto &source : sources) {
+        page.Histogram("sudoku_solve_duration_seconds", source.labels, source.totals.latency,
+                       kLatencyBounds, 1e9);
+    }
+
+    page.Family("sudoku_solve_duration_quantile_seconds", "gauge",
+                "Quantiles of the time taken to solve a puzzle, within 6%.");
+    for (const auto &source : sources) {
+        for (const double quantile : kLatencyQuantiles) {
+            char label[32];
+            std::snprintf(label, sizeof(label), ",quantile=\"%g\"", quantile);
+            page.Sample("sudoku_solve_duration_quantile_seconds", source.labels + label,
+                        source.totals.latency.Quantile(quantile) / 1e9);
+        }
+    }
+
+    page.Family("sudoku_solve_nodes", "histogram",
+                "Search nodes (branches, guesses or conflicts) taken to solve a puzzle.");
+    for (const auto &source : sources) {
+        page.Histogram("sudoku_solve_nodes", source.labels, source.totals.nodes, kNodeBounds, 1);
+    }
+
+    const std::uint64_t hits = cache_.Hits();
+    const std::uint64_t misses = cache_.Misses();
+    page.Family("sudoku_cache_hits_total", "counter", "Puzzles answered from the cache.");
+    page.Sample("sudoku_cache_hits_total", "", hits);
+    page.Family("sudoku_cache_misses_total", "counter", "Puzzles not found in the cache.");
+    page.Sample("sudoku_cache_misses_total", "", misses);
+    page.Family("sudoku_cache_hit_ratio", "gauge", "Share of cache lookups that hit.");
+    page.Sample("sudoku_cache_hit_ratio", "",
+                hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0);
+
+    const BatcherStats stats = batcher_.Stats();
+    page.Family("sudoku_queue_depth", "gauge", "Puzzles waiting to join a batch.");
+    page.Sample("sudoku_queue_depth", "", static_cast<std::uint64_t>(stats.queued));
+    page.Family("sudoku_pending_puzzles", "gauge", "Puzzles queued or being solved.");
+    page.Sample("sudoku_pending_puzzles", "", static_cast<std::uint64_t>(stats.pending));
+    page.Family("sudoku_pending_puzzles_peak", "gauge", "Most puzzles queued or being solved.");
+    page.Sample("sudoku_pending_puzzles_peak", "", static_cast<std::uint64_t>(stats.peak_pending));
+    page.Family("sudoku_admitted_total", "counter", "Puzzles taken into the queue.");
+    page.Sample("sudoku_admitted_total", "", stats.admitted);
+    page.Family("sudoku_shed_total", "counter", "Puzzles shed under load, by reason.");
+    page.Sample("sudoku_shed_total", "reason=\"rejected\"", stats.rejected);
+    page.Sample("sudoku_shed_total", "reason=\"dropped\"", stats.dropped);
+    page.Family("sudoku_degraded_total", "counter",
+                "Puzzles solved by the degrade engine under load.");
+    page.Sample("sudoku_degraded_total", "", stats.degraded);
+    page.Family("sudoku_triaged_total", "counter",
+                "Puzzles finished by propagation alone, without reaching an engine.");
+    page.Sample("sudoku_triaged_total", "", stats.triaged);
+    page.Family("sudoku_batches_total", "counter", "Batches dispatched to the workers.");
+    page.Sample("sudoku_batches_total", "", static_cast<std::uint64_t>(batcher_.BatchCount()));
+
+    page.Family("sudoku_connections", "gauge", "Open client connections.");
+    page.Sample("sudoku_connections", "", static_cast<std::uint64_t>(connection_count_));
+
+    text += page.Text();
+}
+
+void Server::DumpMetrics() {
+    std::string text;
+    WriteMetrics(text);
+
+    // written aside and renamed into place, so readers never see half a page
+    const std::string temporary = options_.metrics_path + ".tmp";
+    {
+        std::ofstream file(temporary);
+        file << text;
+        if (!file) {
+            return;
+        }
+    }
+    std::rename(temporary.c_str(), options_.metrics_path.c_str());
+}
+
+bool Server::HandleLine(const std::string &line, std::string &reply) {
+    reply.clear();
+    HandleLines({line}, reply);
+    if (reply.empty()) {
+        return false;
+    }
+
+    reply.pop_back();
+    return true;
+}
+
+void Server::HandleLines(const std::vector<std::string> &lines, std::string &replies) {
+    // Replies are worked out in three passes so every puzzle that needs
+    // solving is in flight at once: answer what we can straight away, wait
+    // for the batcher, then write everything out in order.
+    std::string buffer;
+    std::vector<LineRange> ranges;
+    for (const auto &line : lines) {
+        ranges.push_back({buffer.size(), line.size()});
+        buffer += line;
+    }
+
+    Group group;
+    Prepare(group, buffer.data(), ranges);
+
+    Completion completion(group.solving);
+    Submit(group, completion);
+    completion.Wait();
+
+    Finish(group);
+    replies += group.replies;
+}
+
+void Server::Prepare(Group &group, const char *buffer, const std::vector<LineRange> &lines) {
+    group.lines.resize(lines.size());
+    group.solving = 0;
+
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        Line &entry = group.lines[i];
+
+        try {
+            if (!ParseRequest(buffer + lines[i].offset, lines[i].length, entry.request.puzzle)) {
+                continue;
+            }
+        } catch (const std::invalid_argument &e) {
+            entry.replied = true;
+            entry.reply = std::string("error: ") + e.what();
+            continue;
+        }
+        entry.replied = true;
+
+        entry.key = entry.request.puzzle.ToString();
+        entry.hash = entry.request.puzzle.Hash();
+        if (cache_.Lookup(entry.hash, entry.key, entry.reply)) {
+            entry.reply = entry.reply.empty() ? kUnsolvableReply : entry.reply;
+        } else {
+            entry.replied = false;
+            ++group.solving;
+        }
+    }
+}
+
+void Server::Submit(Group &group, Completion &completion) {
+    for (auto &entry : group.lines) {
+        if (!entry.replied && !entry.key.empty()) {
+            batcher_.Submit(&entry.request, &completion);
+        }
+    }
+}
+
+void Server::Finish(Group &group) {
+    for (auto &entry : group.lines) {
+        if (!entry.replied && !entry.key.empty() && entry.request.shed) {
+            // not cached, so a retry gets solved once the load has passed
+            entry.reply = kOverloadedReply;
+            entry.replied = true;
+        } else if (!entry.replied && !entry.key.empty()) {
+            const std::string solution =
+                entry.request.solved ? entry.request.puzzle.ToString() : std::string();
+            cache_.Insert(entry.hash, entry.key, solution);
+            entry.reply = solution.empty() ? kUnsolvableReply : solution;
+            entry.replied = true;
+        }
+
+        if (entry.replied) {
+            group.replies += entry.reply;
+            group.replies += '\n';
+        }
+    }
+
+    group.lines.clear();
+    group.done = true;
+}
+
+void Server::Accept() {
+    while (true) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                // The backlog stays readable, so epoll would report it again
+                // straight away. Stop listening until a connection closes and
+                // gives back its descriptor.
+                Control(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, 0);
+                accepting_ = false;
+            }
+            // EAGAIN once the backlog is empty
+            return;
+        }
+
+        std::unique_ptr<Connection> connection(new Connection);
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        Control(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN);
+
+        connections_[fd] = std::move(connection);
+        ++connection_count_;
+    }
+}
+
+void Server::Read(Connection &connection) {
+    lines_.clear();
+    char chunk[4096];
+    while (!connection.read_closed) {
+        ssize_t count = read(connection.fd, chunk, sizeof(chunk));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (count <= 0) {
+            connection.read_closed = true;
+            break;
+        }
+        connection.input.Append(chunk, static_cast<std::size_t>(count));
+        connection.input.TakeLines(lines_);
+    }
+
+    if (lines_.empty()) {
+        return;
+    }
+
+    std::unique_ptr<Group> group(new Group);
+    group->owner = &connection;
+    Prepare(*group, connection.input.Data(), lines_);
+    connection.input.Consume();
+
+    Group *pending = group.get();
+    connection.groups.push_back(std::move(group));
+
+    if (pending->solving == 0) {
+        Finish(*pending);
+        Flush(connection);
+        return;
+    }
+
+    ++pending_groups_;
+    pending->completion.reset(new Completion(pending->solving, [this, pending] {
+        {
+            std::lock_guard<std::mutex> lock(finished_mutex_);
+            finished_.push_back(pending);
+        }
+        Wake();
+    }));
+    Submit(*pending, *pending->completion);
+}
+
+void Server::CollectFinished() {
+    std::vector<Group *> finished;
+    {
+        std::lock_guard<std::mutex> lock(finished_mutex_);
+        finished.swap(finished_);
+    }
+
+    // a connection stays open while it has groups in flight
+    std::vector<int> owners;
+    for (Group *group : finished) {
+        Finish(*group);
+        --pending_groups_;
+        owners.push_back(group->owner->fd);
+    }
+    std::sort(owners.begin(), owners.end());
+    owners.erase(std::unique(owners.begin(), owners.end()), owners.end());
+
+    for (const int fd : owners) {
+        Connection &connection = *connections_.at(fd);
+        Flush(connection);
+        if (!CloseIfDone(connection)) {
+            Watch(connection);
+        }
+    }
+}
+
+void Server::Flush(Connection &connection) {
+    // Replies go out in request order, so a finished group waits for the
+    // ones before it
+    while (!connection.groups.empty() && connection.groups.front()->done) {
+        std::string &replies = connection.groups.front()->replies;
+        if (!connection.failed && !replies.empty()) {
+            connection.unsent += replies.size();
+            connection.output.push_back(std::move(replies));
+        }
+        connection.groups.pop_front();
+    }
+
+    while (!connection.failed && !connection.output.empty()) {
+        iovec buffers[kMaxWriteBuffers];
+        int count = 0;
+        for (auto &output : connection.output) {
+            if (count == kMaxWriteBuffers) {
+                break;
+            }
+            std::size_t skip = (count == 0) ? connection.written : 0;
+            buffers[count].iov_base = &output[skip];
+            buffers[count].iov_len = output.size() - skip;
+            ++count;
+        }
+
+        // sendmsg is writev with MSG_NOSIGNAL, so a vanished client doesn't
+        // raise SIGPIPE
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = buffers;
+        message.msg_iovlen = static_cast<std::size_t>(count);
+
+        ssize_t result = sendmsg(connection.fd, &message, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (result < 0) {
+            connection.failed = true;
+            connection.read_closed = true;
+            break;
+        }
+
+        std::size_t sent = static_cast<std::size_t>(result);
+        connection.unsent -= sent;
+        while (sent > 0) {
+            std::size_t left = connection.output.front().size() - connection.written;
+            if (sent < left) {
+                connection.written += sent;
+                break;
+            }
+            sent -= left;
+            connection.output.pop_front();
+            connection.written = 0;
+        }
+    }
+
+    if (connection.failed) {
+        connection.output.clear();
+        connection.written = 0;
+        connection.unsent = 0;
+    }
+}
+
+void Server::Watch(Connection &connection) {
+    // A connection asking for nothing is taken out of the epoll set, since
+    // hangups are reported whatever the mask
+    std::uint32_t events = 0;
+    if (!connection.failed && !connection.read_closed && connection.unsent < kMaxPendingOutput) {
+        events |= EPOLLIN;
+    }
+    if (!connection.failed && !connection.output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events == connection.events) {
+        return;
+    }
+
+    int operation = EPOLL_CTL_MOD;
+    if (connection.events == 0) {
+        operation = EPOLL_CTL_ADD;
+    } else if (events == 0) {
+        operation = EPOLL_CTL_DEL;
+    }
+    Control(epoll_fd_, operation, connection.fd, events);
+    connection.events = events;
+}
+
+bool Server::CloseIfDone(Connection &connection) {
+    if (!connection.read_closed || !connection.groups.empty() || !connection.output.empty()) {
+        return false;
+    }
+
+    // closing the descriptor also takes it out of the epoll set
+    const int fd = connection.fd;
+    close(fd);
+    connections_.erase(fd);
+    --connection_count_;
+
+    // a descriptor is free again, so Accept may have stopped for want of one
+    if (!accepting_ && !stopping_) {
+        Control(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+        accepting_ = true;
+    }
+    return true;
+}
+}  // namespace Sudoku
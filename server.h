@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "batcher.h"
+#include "puzzle.h"
+#include "solution_cache.h"
+
+namespace Sudoku {
+
+// Reply sent for puzzles without a solution
+const std::string kUnsolvableReply = "unsolvable";
+
+// Reply sent for puzzles shed because the server is overloaded (see
+// ShedPolicy); sending them again later may succeed
+const std::string kOverloadedReply = "overloaded";
+
+// Longest request line read. Longer lines are answered with an error and
+// skipped, so a client that never sends a newline can't grow its buffer.
+const std::size_t kMaxLineLength = 4096;
+
+// One line of a LineReader's buffer, without its line ending
+struct LineRange {
+    std::size_t offset;
+    std::size_t length;
+};
+
+// Splits a connection's input into request lines as it arrives, handing the
+// lines out as ranges of its buffer instead of copies. The ranges stay valid
+// until Consume, which drops the lines handed out so far; once the buffer has
+// grown to fit the usual reads, none of this touches the heap.
+//
+// A line that runs past kMaxLineLength is handed out as soon as it does,
+// cut to kMaxLineLength + 1 characters, and the rest of it is dropped as it
+// arrives.
+class LineReader {
+   public:
+    void Append(const char *data, std::size_t size);
+
+    // Appends the ranges of the lines completed since the last call to lines
+    void TakeLines(std::vector<LineRange> &lines);
+
+    // Drops the lines handed out, invalidating their ranges
+    void Consume();
+
+    const char *Data() const { return input_.data(); }
+
+   private:
+    std::string input_;
+    // start of the first line not handed out yet
+    std::size_t line_start_ = 0;
+    // input_ before this offset holds no newline after line_start_
+    std::size_t scanned_ = 0;
+    // the line being read was too long, so input is dropped up to its newline
+    bool skipping_ = false;
+};
+
+// Parses one request line into puzzle. Returns false for lines that get no
+// reply: blank lines and comments starting with '#'. Throws
+// std::invalid_argument, with the reason to send back, for lines that aren't
+// puzzles or are too long.
+bool ParseRequest(const char *line, const std::size_t length, Puzzle &puzzle);
+
+struct ServerOptions {
+    // Filesystem path of the Unix domain socket to listen on
+    std::string socket_path;
+
+    // Engine used for every puzzle, by name (see MakeEngine)
+    std::string engine = "band";
+
+    // Solving threads, or one per hardware thread if 0
+    unsigned threads = 0;
+
+    // Solved puzzles remembered between requests
+    std::size_t cache_size = 1 << 16;
+
+    // How puzzles from all connections are grouped for the solving threads
+    BatchOptions batch;
+
+    // File the metrics page (see Server::WriteMetrics) is written to every
+    // metrics_interval, in the format of the Prometheus node exporter's
+    // textfile collector. Empty for none.
+    std::string metrics_path;
+    std::chrono::milliseconds metrics_interval{1000};
+};
+
+// Long running solve service on a Unix domain socket, so repeated small
+// requests don't pay for process startup and cold caches.
+//
+// Clients write puzzles one per line in the SPF cell format (as accepted by
+// the Puzzle constructor) and get one line back per puzzle, in order: the
+// solved grid in the same format, kUnsolvableReply, kOverloadedReply, or
+// "error: " and the reason the line couldn't be read. Blank lines and lines
+// starting with '#' (such as the "# spf1.0" header) get no reply.
+//
+// One thread runs an epoll loop over non-blocking sockets, so idle
+// connections cost a buffer each rather than a thread. Input is split into
+// lines as it arrives; the complete lines of each read form a group that is
+// answered from the cache where possible and otherwise handed to the
+// SolveBatcher, which coalesces puzzles from all connections into
+// micro-batches for its warm worker engines. Finished groups are written
+// back in order with writev. A connection whose client doesn't read its
+// replies isn't read from either until it catches up, and a line that runs
+// past 4096 bytes is answered with "error: line too long" and skipped.
+class Server {
+   public:
+    // Throws std::invalid_argument for an unknown engine
+    explicit Server(const ServerOptions &options);
+
+    // Stops the server and removes the socket file
+    ~Server();
+
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    // Creates the socket and starts listening. Throws std::system_error.
+    void Listen();
+
+    // Serves connections until Stop is called. Returns once every puzzle
+    // already received has been answered.
+    void Run();
+
+    // Makes Run return. Safe to call from any thread.
+    void Stop();
+
+    // Works out the reply to one request line. Returns false if the line gets
+    // no reply.
+    bool HandleLine(const std::string &line, std::string &reply);
+
+    // Works out the replies to several request lines at once, appending each
+    // reply and a newline to replies in request order
+    void HandleLines(const std::vector<std::string> &lines, std::string &replies);
+
+    const SolutionCache &Cache() const { return cache_; }
+
+    const SolveBatcher &Batcher() const { return batcher_; }
+
+    // Number of open client connections
+    std::size_t ConnectionCount() const { return connection_count_; }
+
+    // Writes the server's metrics in the Prometheus text format: solves and
+    // solves per second by engine, solve time and search size histograms,
+    // cache hits, queue depths and shedding counts, and open connections.
+    // Rates cover the time since the previous call.
+    void WriteMetrics(std::string &text);
+
+   private:
+    struct Line {
+        bool replied = false;
+        std::string reply;
+        std::string key;
+        std::uint64_t hash = 0;
+        SolveRequest request;
+    };
+
+    struct Connection;
+
+    // The lines of one read, answered together
+    struct Group {
+        std::vector<Line> lines;
+        std::size_t solving = 0;
+        std::unique_ptr<Completion> completion;
+        std::string replies;
+        bool done = false;
+        Connection *owner = nullptr;
+    };
+
+    struct Connection {
+        int fd = -1;
+        LineReader input;
+        std::deque<std::unique_ptr<Group>> groups;
+        std::deque<std::string> output;
+        // bytes of output.front() already written
+        std::size_t written = 0;
+        // bytes of output not written yet; past kMaxPendingOutput no more
+        // requests are read until the client catches up
+        std::size_t unsent = 0;
+        // epoll events currently asked for, 0 when not in the epoll set
+        std::uint32_t events = 0;
+        // no more requests will be read
+        bool read_closed = false;
+        // the peer is gone, so replies are dropped
+        bool failed = false;
+    };
+
+    ServerOptions options_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    // listen_fd_ is in the epoll set
+    bool accepting_ = false;
+    std::atomic<bool> stopping_{false};
+
+    std::map<int, std::unique_ptr<Connection>> connections_;
+    std::atomic<std::size_t> connection_count_{0};
+    std::size_t pending_groups_ = 0;
+    // lines of the connection being read, reused from read to read
+    std::vector<LineRange> lines_;
+
+    // groups whose last solve finished on a worker, for the loop to pick up
+    std::mutex finished_mutex_;
+    std::vector<Group *> finished_;
+
+    SolutionCache cache_;
+    SolveBatcher batcher_;
+
+    // solve counts at the previous WriteMetrics, for the rates
+    std::mutex metrics_mutex_;
+    std::chrono::steady_clock::time_point started_;
+    std::chrono::steady_clock::time_point last_metrics_;
+    std::map<std::string, std::uint64_t> last_solves_;
+
+    // Parses the lines of buffer and answers what it can from the cache,
+    // counting the lines still to be solved in group.solving
+    void Prepare(Group &group, const char *buffer, const std::vector<LineRange> &lines);
+    void Submit(Group &group, Completion &completion);
+    // Caches the solutions and writes out the group's replies
+    void Finish(Group &group);
+
+    void Wake();
+    void DumpMetrics();
+    void Accept();
+    void Read(Connection &connection);
+    void CollectFinished();
+    void Flush(Connection &connection);
+    void Watch(Connection &connection);
+
+    // Closes the connection if nothing is left to do for it. Returns true if
+    // it was closed.
+    bool CloseIfDone(Connection &connection);
+};
+}  // namespace Sudoku
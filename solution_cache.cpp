@@ -0,0 +1,62 @@
+#include "solution_cache.h"
+
+namespace Sudoku {
+
+const std::size_t SolutionCache::kShardCount;
+
+SolutionCache::SolutionCache(const std::size_t capacity) : entries_(capacity) {}
+
+bool SolutionCache::Lookup(const std::uint64_t hash, const std::string &puzzle,
+                           std::string &solution) {
+    if (entries_.empty()) {
+        return false;
+    }
+
+    const std::size_t slot = hash % entries_.size();
+    Shard &shard = ShardOf(slot);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const Entry &entry = entries_[slot];
+    if (entry.hash != hash || entry.puzzle != puzzle) {
+        ++shard.misses;
+        return false;
+    }
+
+    ++shard.hits;
+    solution = entry.solution;
+    return true;
+}
+
+void SolutionCache::Insert(const std::uint64_t hash, const std::string &puzzle,
+                           const std::string &solution) {
+    if (entries_.empty()) {
+        return;
+    }
+
+    const std::size_t slot = hash % entries_.size();
+    std::lock_guard<std::mutex> lock(ShardOf(slot).mutex);
+
+    Entry &entry = entries_[slot];
+    entry.hash = hash;
+    entry.puzzle = puzzle;
+    entry.solution = solution;
+}
+
+std::uint64_t SolutionCache::Hits() const {
+    std::uint64_t hits = 0;
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        hits += shard.hits;
+    }
+    return hits;
+}
+
+std::uint64_t SolutionCache::Misses() const {
+    std::uint64_t misses = 0;
+    for (auto &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        misses += shard.misses;
+    }
+    return misses;
+}
+}  // namespace Sudoku
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Sudoku {
+
+// Fixed size, direct mapped cache of solved puzzles keyed by the puzzle's
+// string form, shared between threads. Lookups and inserts lock one of a
+// fixed number of shards, and an insert simply replaces whatever shared its
+// slot.
+class SolutionCache {
+   public:
+    // Holds up to capacity entries; a capacity of 0 disables the cache
+    explicit SolutionCache(const std::size_t capacity);
+
+    // Finds the cached answer for a puzzle. solution is left empty if the
+    // puzzle was found to have no solution.
+    bool Lookup(const std::uint64_t hash, const std::string &puzzle, std::string &solution);
+
+    void Insert(const std::uint64_t hash, const std::string &puzzle, const std::string &solution);
+
+    std::uint64_t Hits() const;
+    std::uint64_t Misses() const;
+
+   private:
+    static const std::size_t kShardCount = 64;
+
+    struct Entry {
+        std::uint64_t hash = 0;
+        std::string puzzle;
+        std::string solution;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+    };
+
+    std::vector<Entry> entries_;
+    mutable std::array<Shard, kShardCount> shards_;
+
+    Shard &ShardOf(const std::size_t slot) { return shards_[slot % kShardCount]; }
+};
+}  // namespace Sudoku
@@ -1,45 +1,255 @@
 #include "solver.h"
 
+#include <stdexcept>
+
+#include "trace.h"
+
 namespace Sudoku {
-std::vector<bool> Solver::SolvePuzzles(std::vector<Puzzle> &puzzles) {
-    std::vector<bool> result_vector;
-    for (auto &puzzle : puzzles) {
-        result_vector.push_back(SolvePuzzle(puzzle));
-    }
 
-    return result_vector;
+namespace {
+template <typename Mask_t>
+int CountValues(const Mask_t mask) {
+    return __builtin_popcount(mask);
+}
+
+template <typename Mask_t>
+int LowestValueIndex(const Mask_t mask) {
+    return __builtin_ctz(mask);
 }
+}  // namespace
 
-bool Solver::SolvePuzzle(Puzzle &puzzle) {
+template <int BoxSize>
+bool BasicSolver<BoxSize>::SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) {
+    nodes_ = 0;
+    next_checkpoint_ = checkpoint_interval_;
+    this->budget_exhausted_ = false;
+    interrupted_ = false;
     if (!puzzle.IsValid()) {
         return false;
     }
 
-    PuzzleCoord_t potential_loc = puzzle.FindUnassignedPosition();
-    if (potential_loc.first == -1 && potential_loc.second == -1) {
-        // we couldn't find a position to fill
-        return true;
+    arena_.Reset();
+    bool attached = puzzle.AttachArena(&arena_);
+
+    bool solved;
+    {
+        SUDOKU_TRACE_SCOPE("search");
+        Stack stack{ArenaAllocator<Frame>(&arena_)};
+        stack.reserve(Geometry::kTotalBoardSize);
+        solved = Search(puzzle, stack);
     }
 
-    PuzzleCoord_t loc = potential_loc;
+    if (attached) {
+        puzzle.AttachArena(nullptr);
+    }
 
-    // Try all valid values for the free location
-    for (unsigned int potential_value = 0; potential_value <= kBoardSize; ++potential_value) {
-        if (puzzle.IsValidAssignment(loc, potential_value)) {
-            // tentative assignment
-            puzzle[loc.first][loc.second] = kUnassigned;
+    return solved;
+}
 
-            // recurse with tentative assignment
-            if (SolvePuzzle(puzzle)) {
-                return true;
+template <int BoxSize>
+bool BasicSolver<BoxSize>::Resume(const BasicSearchCheckpoint<BoxSize> &checkpoint,
+                                  BasicPuzzle<BoxSize> &puzzle) {
+    puzzle = BasicPuzzle<BoxSize>(checkpoint.board);
+    if (!puzzle.IsValid()) {
+        throw std::invalid_argument("Checkpoint board has conflicting givens");
+    }
+
+    nodes_ = checkpoint.nodes;
+    next_checkpoint_ = nodes_ + checkpoint_interval_;
+    this->budget_exhausted_ = false;
+    interrupted_ = false;
+
+    arena_.Reset();
+    bool attached = puzzle.AttachArena(&arena_);
+
+    bool solved;
+    {
+        SUDOKU_TRACE_SCOPE("search");
+        Stack stack{ArenaAllocator<Frame>(&arena_)};
+        stack.reserve(Geometry::kTotalBoardSize);
+
+        // rebuild the trail by replaying the stack
+        for (const auto &saved : checkpoint.frames) {
+            const Mask_t remaining = static_cast<Mask_t>(saved.remaining);
+            const bool consistent = saved.cell >= 0 && saved.cell < Geometry::kTotalBoardSize &&
+                                    puzzle.GetCell(saved.cell) == kUnassigned &&
+                                    (remaining & Geometry::ValueBit(saved.value)) == 0;
+            if (consistent) {
+                puzzle.Checkpoint();
+                stack.push_back({static_cast<typename Geometry::Cell_t>(saved.cell), remaining});
+                puzzle.Assign(saved.cell, saved.value);
             }
 
-            // attempt failed, trying again
-            puzzle[loc.first][loc.second] = potential_value;
+            if (!consistent || !puzzle.IsValid()) {
+                for (std::size_t i = 0; i < stack.size(); ++i) {
+                    puzzle.Rollback();
+                }
+                if (attached) {
+                    puzzle.AttachArena(nullptr);
+                }
+                throw std::invalid_argument("Checkpoint frames don't fit its board");
+            }
         }
+
+        const bool lexicographic = lexicographic_;
+        lexicographic_ = checkpoint.lexicographic;
+        solved = Search(puzzle, stack);
+        lexicographic_ = lexicographic;
+    }
+
+    if (attached) {
+        puzzle.AttachArena(nullptr);
     }
 
-    return false;
+    return solved;
 }
 
-}  // namespace Sudoku
\ No newline at end of file
+template <int BoxSize>
+bool BasicSolver<BoxSize>::Search(BasicPuzzle<BoxSize> &puzzle, Stack &stack) {
+    // Every frame whose current value is applied to the puzzle has exactly one
+    // open checkpoint.
+    while (true) {
+        if ((checkpoint_interval_ != 0 && nodes_ >= next_checkpoint_) ||
+            requests_.load(std::memory_order_relaxed) != 0) {
+            if (!HandleRequests(puzzle, stack)) {
+                for (std::size_t i = 0; i < stack.size(); ++i) {
+                    puzzle.Rollback();
+                }
+
+                interrupted_ = true;
+                return false;
+            }
+        }
+
+        if (puzzle.FilledCount() == Geometry::kTotalBoardSize) {
+            // we couldn't find a position to fill
+            for (std::size_t i = 0; i < stack.size(); ++i) {
+                puzzle.Commit();
+            }
+
+            return true;
+        }
+
+        Frame frame;
+        if (SelectCell(puzzle, frame)) {
+            stack.push_back(frame);
+        } else if (stack.empty()) {
+            return false;
+        } else {
+            // dead end, undo the latest tentative assignment
+            puzzle.Rollback();
+        }
+
+        // attempt failed, back up to the deepest cell with values left to try
+        while (stack.back().remaining == 0) {
+            stack.pop_back();
+            if (stack.empty()) {
+                return false;
+            }
+
+            puzzle.Rollback();
+        }
+
+        if (this->node_limit_ != 0 && nodes_ >= this->node_limit_) {
+            // out of budget; only the frames below the top have a value applied
+            for (std::size_t i = 1; i < stack.size(); ++i) {
+                puzzle.Rollback();
+            }
+
+            this->budget_exhausted_ = true;
+            return false;
+        }
+        ++nodes_;
+
+        Frame &top = stack.back();
+        int value = LowestValueIndex(top.remaining) + 1;
+        top.remaining &= static_cast<Mask_t>(top.remaining - 1);
+
+        // tentative assignment
+        puzzle.Checkpoint();
+        puzzle.Assign(top.cell, value);
+    }
+}
+
+template <int BoxSize>
+bool BasicSolver<BoxSize>::HandleRequests(const BasicPuzzle<BoxSize> &puzzle, const Stack &stack) {
+    const int requests = requests_.exchange(0, std::memory_order_relaxed);
+
+    bool snapshot = (requests & kCheckpointRequest) != 0;
+    if (checkpoint_interval_ != 0 && nodes_ >= next_checkpoint_) {
+        snapshot = true;
+        next_checkpoint_ = nodes_ + checkpoint_interval_;
+    }
+
+    if (snapshot && checkpoint_handler_) {
+        checkpoint_handler_(Snapshot(puzzle, stack));
+    }
+
+    return (requests & kStopRequest) == 0;
+}
+
+template <int BoxSize>
+BasicSearchCheckpoint<BoxSize> BasicSolver<BoxSize>::Snapshot(const BasicPuzzle<BoxSize> &puzzle,
+                                                              const Stack &stack) const {
+    BasicSearchCheckpoint<BoxSize> checkpoint;
+    checkpoint.board = puzzle.ToString();
+    checkpoint.nodes = nodes_;
+    checkpoint.lexicographic = lexicographic_;
+
+    // the cells on the stack are the search's guesses, not givens
+    for (const Frame &frame : stack) {
+        checkpoint.board[frame.cell] = kUnassignedChar;
+        checkpoint.frames.push_back({frame.cell, puzzle.GetCell(frame.cell), frame.remaining});
+    }
+
+    return checkpoint;
+}
+
+template <int BoxSize>
+bool BasicSolver<BoxSize>::SelectCell(const BasicPuzzle<BoxSize> &puzzle, Frame &frame) const {
+    int best_count = Geometry::kBoardSize + 1;
+
+    CandidateTable<BoxSize> table;
+    puzzle.AllCandidates(table);
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        Mask_t candidates = table[cell];
+
+        // Assigned cells have no candidates either, so only look at the cell
+        // itself to tell them apart from a dead end
+        if (candidates == 0) {
+            if (puzzle.GetCell(cell) == kUnassigned) {
+                return false;
+            }
+            continue;
+        }
+
+        int count = CountValues(candidates);
+
+        // In lexicographic order keep the first open cell, unless a cell
+        // further on has a single candidate: that value is forced, so taking
+        // it first can't change which solution is found first
+        if (count < best_count &&
+            (!lexicographic_ || count == 1 || best_count > Geometry::kBoardSize)) {
+            frame.cell = static_cast<typename Geometry::Cell_t>(cell);
+            frame.remaining = candidates;
+            best_count = count;
+
+            if (count <= 1) {
+                break;
+            }
+        }
+    }
+
+    return best_count > 0;
+}
+
+template <int BoxSize>
+const int BasicSolver<BoxSize>::kCheckpointRequest;
+template <int BoxSize>
+const int BasicSolver<BoxSize>::kStopRequest;
+
+template class BasicSolver<3>;
+template class BasicSolver<4>;
+template class BasicSolver<5>;
+}  // namespace Sudoku
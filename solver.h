@@ -1,23 +1,133 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <vector>
 
+#include "arena.h"
+#include "engine.h"
 #include "puzzle.h"
+#include "search_checkpoint.h"
 
 namespace Sudoku {
 
 // class largely based off of
 // https://www.geeksforgeeks.org/sudoku-backtracking-7/. This class focuses on
 // solving sudoku puzzles.
-class Solver {
+//
+// The search runs directly on the puzzle's candidate masks (sized for the
+// board, see BoardGeometry), always branching on the empty cell with the
+// fewest candidates, and backtracks with the puzzle's checkpoint trail. The
+// search is iterative; its stack and the puzzle's trail live in an arena owned
+// by the solver and reset between puzzles, so after the first few puzzles of a
+// batch solving does no heap allocation. A solver must only be used by one
+// thread at a time, though RequestCheckpoint and RequestStop may be called from
+// anywhere.
+//
+// Long searches can be checkpointed: the solver hands a BasicSearchCheckpoint
+// to a handler every so many nodes or when asked to, and Resume carries on
+// from one later.
+template <int BoxSize>
+class BasicSolver : public BasicEngine<BoxSize> {
  public:
-  // Given a vector of puzzles to solve, returns a vector of boolean values
-  // representing which puzzles were solved.
-  std::vector<bool> SolvePuzzles(std::vector<Puzzle> &puzzles);
+  using Geometry = BoardGeometry<BoxSize>;
+  using Mask_t = typename Geometry::Mask_t;
+
+  const char *Name() const override { return "backtrack"; }
 
   // Attempts to solve a single puzzle, and returns true if it was able to be
   // solved.
-  bool SolvePuzzle(Puzzle &puzzle);
+  bool SolvePuzzle(BasicPuzzle<BoxSize> &puzzle) override;
+
+  std::uint64_t LastNodes() const override { return nodes_; }
+
+  // Branches on the first empty cell, after any cells with a single
+  // candidate, instead of the most constrained one. That can take far more
+  // nodes on hard puzzles.
+  bool SetLexicographic(const bool lexicographic) override {
+    lexicographic_ = lexicographic;
+    return true;
+  }
+
+  using CheckpointHandler = std::function<void(const BasicSearchCheckpoint<BoxSize> &)>;
+
+  // Calls handler with a snapshot of the search every interval nodes, and
+  // whenever one is requested; an interval of 0 only snapshots on request.
+  // An empty handler turns checkpointing off.
+  void SetCheckpointHandler(const std::uint64_t interval, CheckpointHandler handler) {
+    checkpoint_interval_ = interval;
+    checkpoint_handler_ = std::move(handler);
+  }
+
+  // Asks the running search for a snapshot at its next node. Only stores to a
+  // lock-free atomic, so it's safe from signal handlers and other threads.
+  void RequestCheckpoint() { requests_.fetch_or(kCheckpointRequest, std::memory_order_relaxed); }
+
+  // Asks the running search to take a snapshot and then give up the puzzle,
+  // leaving it as it was; LastInterrupted() then returns true. Safe from
+  // signal handlers and other threads too.
+  void RequestStop() {
+    requests_.fetch_or(kCheckpointRequest | kStopRequest, std::memory_order_relaxed);
+  }
+
+  // Whether the last puzzle was given up because of RequestStop
+  bool LastInterrupted() const { return interrupted_; }
+
+  // Carries on the search a checkpoint was taken of, filling puzzle with the
+  // solution if one is found. The search keeps the checkpoint's order, whatever
+  // SetLexicographic was given. LastNodes counts on from the checkpoint's nodes.
+  // Throws std::invalid_argument if the checkpoint doesn't describe a search of
+  // its board.
+  bool Resume(const BasicSearchCheckpoint<BoxSize> &checkpoint, BasicPuzzle<BoxSize> &puzzle);
+
+ private:
+  // One level of the search: the cell being branched on and the values not
+  // yet tried there
+  struct Frame {
+    typename Geometry::Cell_t cell;
+    Mask_t remaining;
+  };
+
+  using Stack = ArenaVector<Frame>;
+
+  static const int kCheckpointRequest = 1;
+  static const int kStopRequest = 2;
+
+  Arena arena_;
+  std::uint64_t nodes_ = 0;
+  bool lexicographic_ = false;
+
+  std::uint64_t checkpoint_interval_ = 0;
+  std::uint64_t next_checkpoint_ = 0;
+  CheckpointHandler checkpoint_handler_;
+  std::atomic<int> requests_{0};
+  bool interrupted_ = false;
+
+  // Runs the search from the given stack, whose frames all have their value
+  // applied to puzzle under one open checkpoint each
+  bool Search(BasicPuzzle<BoxSize> &puzzle, Stack &stack);
+
+  // Answers pending checkpoint and stop requests at the top of the search
+  // loop. Returns false if the search should stop.
+  bool HandleRequests(const BasicPuzzle<BoxSize> &puzzle, const Stack &stack);
+
+  BasicSearchCheckpoint<BoxSize> Snapshot(const BasicPuzzle<BoxSize> &puzzle,
+                                          const Stack &stack) const;
+
+  // Finds the unassigned cell with the fewest candidates, or in
+  // lexicographic order the first unassigned one. Returns false if some
+  // unassigned cell has no candidates left.
+  bool SelectCell(const BasicPuzzle<BoxSize> &puzzle, Frame &frame) const;
 };
+
+using Solver = BasicSolver<3>;
+using Solver16 = BasicSolver<4>;
+using Solver25 = BasicSolver<5>;
+
+// Instantiated in solver.cpp
+extern template class BasicSolver<3>;
+extern template class BasicSolver<4>;
+extern template class BasicSolver<5>;
 }  // namespace Sudoku
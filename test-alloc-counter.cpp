@@ -0,0 +1,107 @@
+#include "alloc_counter.h"
+#include "catch.hpp"
+#include "generator.h"
+#include "server.h"
+#include "solver.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The tests binary links alloc_counter.o, so these count every heap
+// allocation the code under test makes. Counts are taken before any REQUIRE,
+// since Catch allocates too.
+using namespace Sudoku;
+
+namespace {
+// A few SPF lines, or the bundled corpus when it's around
+std::string CorpusText() {
+    std::ifstream corpus("corpus.spf");
+    if (corpus) {
+        std::ostringstream text;
+        text << corpus.rdbuf();
+        return text.str();
+    }
+
+    return "# spf1.0\n"
+           "91_86___44__7____1_7_________1__2__874___69_____________9__4_6_______51__2_9_____\n"
+           "_6_47__9__________8__5________3_7_6__4_9__8_2____547___13___5____4_3______76_52__\n"
+           "__7____1_1_____6_8__6__2_7_2_4______8____4_9_______5_3_5____1____28_9_6___9__1__\n";
+}
+
+std::uint64_t AllocationsSince(const AllocationCounts &before) {
+    return ThreadAllocations().allocations - before.allocations;
+}
+}  // namespace
+
+TEST_CASE("Allocation counts track new and delete", "[allocations]") {
+    AllocationCounts before = ThreadAllocations();
+    std::vector<int> *numbers = new std::vector<int>(100);
+    AllocationCounts after = ThreadAllocations();
+    delete numbers;
+
+    REQUIRE(after.allocations - before.allocations == 2);
+    REQUIRE(after.bytes - before.bytes == sizeof(std::vector<int>) + 100 * sizeof(int));
+}
+
+TEST_CASE("Solver doesn't allocate once warmed up", "[allocations]") {
+    std::istringstream corpus(CorpusText());
+    std::vector<Puzzle> puzzles = Generator::ReadPuzzles(corpus);
+    REQUIRE(!puzzles.empty());
+
+    Solver solver;
+
+    // warm-up: the first solves grow the solver's arena to the size the
+    // deepest search needs
+    std::vector<Puzzle> warm_up = puzzles;
+    for (auto &puzzle : warm_up) {
+        solver.SolvePuzzle(puzzle);
+    }
+
+    std::size_t solved = 0;
+    AllocationCounts before = ThreadAllocations();
+    for (auto &puzzle : puzzles) {
+        solved += solver.SolvePuzzle(puzzle) ? 1 : 0;
+    }
+    std::uint64_t allocations = AllocationsSince(before);
+
+    REQUIRE(solved == puzzles.size());
+    REQUIRE(allocations == 0);
+}
+
+TEST_CASE("Parsing SPF lines doesn't allocate once warmed up", "[allocations]") {
+    const std::string text = CorpusText();
+    LineReader reader;
+    std::vector<LineRange> lines;
+    Puzzle puzzle;
+
+    // The server's parse path: each socket-sized read goes through the
+    // connection's LineReader, and Prepare parses every line it hands out
+    // straight from the buffer with ParseRequest
+    auto parse_all = [&]() {
+        std::size_t parsed = 0;
+        for (std::size_t offset = 0; offset < text.size(); offset += 4096) {
+            reader.Append(text.data() + offset, std::min<std::size_t>(4096, text.size() - offset));
+            lines.clear();
+            reader.TakeLines(lines);
+
+            for (const LineRange &line : lines) {
+                parsed += ParseRequest(reader.Data() + line.offset, line.length, puzzle) ? 1 : 0;
+            }
+            reader.Consume();
+        }
+
+        return parsed;
+    };
+
+    parse_all();
+
+    AllocationCounts before = ThreadAllocations();
+    std::size_t parsed = parse_all();
+    std::uint64_t allocations = AllocationsSince(before);
+
+    REQUIRE(parsed > 0);
+    REQUIRE(allocations == 0);
+}
@@ -0,0 +1,81 @@
+#include "arena.h"
+#include "catch.hpp"
+
+#include <cstdint>
+
+using namespace Sudoku;
+
+TEST_CASE("Arenas hand out aligned memory", "[arena]") {
+    Arena arena(256);
+
+    SECTION("Allocations respect alignment") {
+        arena.Allocate(1, 1);
+        void *aligned = arena.Allocate(sizeof(std::uint64_t), alignof(std::uint64_t));
+
+        REQUIRE(reinterpret_cast<std::uintptr_t>(aligned) % alignof(std::uint64_t) == 0);
+    }
+
+    SECTION("Allocations don't overlap") {
+        auto *first = static_cast<unsigned char *>(arena.Allocate(16, 1));
+        auto *second = static_cast<unsigned char *>(arena.Allocate(16, 1));
+
+        REQUIRE((second >= first + 16 || second + 16 <= first));
+    }
+
+    SECTION("Oversized requests get their own block") {
+        arena.Allocate(1024, 8);
+        REQUIRE(arena.BytesReserved() >= 1024);
+    }
+}
+
+TEST_CASE("Arenas reuse their blocks after a reset", "[arena]") {
+    Arena arena(256);
+
+    for (int i = 0; i < 8; ++i) {
+        arena.Allocate(100, 8);
+    }
+
+    std::size_t blocks = arena.BlockCount();
+    std::size_t reserved = arena.BytesReserved();
+
+    for (int round = 0; round < 4; ++round) {
+        arena.Reset();
+        for (int i = 0; i < 8; ++i) {
+            arena.Allocate(100, 8);
+        }
+    }
+
+    REQUIRE(arena.BlockCount() == blocks);
+    REQUIRE(arena.BytesReserved() == reserved);
+}
+
+TEST_CASE("Arena allocators back standard containers", "[arena]") {
+    Arena arena;
+
+    SECTION("Vectors grow inside the arena") {
+        ArenaVector<int> values{ArenaAllocator<int>(&arena)};
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back(i);
+        }
+
+        REQUIRE(values[999] == 999);
+        REQUIRE(arena.BlockCount() == 1);
+    }
+
+    SECTION("Copies fall back to the heap") {
+        ArenaVector<int> values{ArenaAllocator<int>(&arena)};
+        values.push_back(1);
+
+        ArenaVector<int> copy(values);
+        REQUIRE(copy.get_allocator().arena() == nullptr);
+        REQUIRE(copy[0] == 1);
+    }
+
+    SECTION("Default allocators use the heap") {
+        ArenaVector<int> values;
+        values.push_back(1);
+
+        REQUIRE(values.get_allocator().arena() == nullptr);
+        REQUIRE(arena.BlockCount() == 0);
+    }
+}
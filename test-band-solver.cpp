@@ -0,0 +1,201 @@
+#include "band_solver.h"
+#include "catch.hpp"
+#include "solver.h"
+
+using namespace Sudoku;
+
+namespace {
+const std::string kEasyString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______6___";
+
+// Needs guessing to solve
+const std::string kHardString =
+    "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9____4__";
+
+// Solved without guessing only with locked candidates across the bands, in
+// the column direction
+const std::string kColumnLockedString =
+    "_612__9_4__5___2______48_3__49_8__53______1_______7_49__8_5__2__7______51____2___";
+
+// kEasyString with two givens removed, which leaves several solutions
+const std::string kAmbiguousString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5__________";
+
+const std::string kConflictingString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
+}  // namespace
+
+TEST_CASE("Band solver solves puzzles", "[band]") {
+    BandSolver band;
+    REQUIRE(std::string(band.Name()) == "band");
+
+    SECTION("Solutions match the backtracking solver") {
+        for (auto &string : {kEasyString, kHardString}) {
+            Puzzle p(string);
+            Puzzle expected(string);
+            Solver solver;
+
+            REQUIRE(band.SolvePuzzle(p));
+            REQUIRE(solver.SolvePuzzle(expected));
+            REQUIRE(p.IsComplete());
+            REQUIRE(p.IsValid());
+            REQUIRE(p.ToString() == expected.ToString());
+        }
+    }
+
+    SECTION("Givens are kept") {
+        Puzzle p(kHardString);
+        Puzzle givens(kHardString);
+        REQUIRE(band.SolvePuzzle(p));
+        for (int cell = 0; cell < givens.Size(); ++cell) {
+            if (givens.GetCell(cell) != kUnassigned) {
+                REQUIRE(p.GetCell(cell) == givens.GetCell(cell));
+            }
+        }
+    }
+
+    SECTION("Locked candidates work across the bands") {
+        Puzzle p(kColumnLockedString);
+        Puzzle expected(kColumnLockedString);
+        Solver solver;
+
+        REQUIRE(band.SolvePuzzle(p));
+        REQUIRE(band.GuessCount() == 0);
+        REQUIRE(solver.SolvePuzzle(expected));
+        REQUIRE(p.ToString() == expected.ToString());
+    }
+
+    SECTION("Conflicting puzzles are rejected") {
+        Puzzle p(kConflictingString);
+        REQUIRE_FALSE(band.SolvePuzzle(p));
+        REQUIRE(p.ToString() == Puzzle(kConflictingString).ToString());
+    }
+
+    SECTION("Empty boards are solved") {
+        Puzzle p;
+        REQUIRE(band.SolvePuzzle(p));
+        REQUIRE(p.IsComplete());
+        REQUIRE(p.IsValid());
+    }
+}
+
+TEST_CASE("Band solver counts solutions", "[band]") {
+    BandSolver band;
+
+    REQUIRE(band.CountSolutions(Puzzle(kEasyString), 2) == 1);
+    REQUIRE(band.CountSolutions(Puzzle(kHardString), 2) == 1);
+    REQUIRE(band.CountSolutions(Puzzle(kAmbiguousString), 2) == 2);
+    REQUIRE(band.CountSolutions(Puzzle(kAmbiguousString), 1) == 1);
+    REQUIRE(band.CountSolutions(Puzzle(kConflictingString), 2) == 0);
+    REQUIRE(band.CountSolutions(Puzzle(), 5) == 5);
+}
+
+TEST_CASE("Band solver finds the lexicographically first solution", "[band]") {
+    BandSolver band;
+    REQUIRE(band.SetLexicographic(true));
+    Solver solver;
+    solver.SetLexicographic(true);
+
+    // the first open cell is branched on whatever the candidate counts, so
+    // agreeing with the backtracking solver's row-major search checks both
+    for (auto &string : {std::string(81, '_'), kAmbiguousString, kHardString}) {
+        Puzzle p(string);
+        Puzzle expected(string);
+        REQUIRE(band.SolvePuzzle(p));
+        REQUIRE(solver.SolvePuzzle(expected));
+        REQUIRE(p.ToString() == expected.ToString());
+    }
+
+    SECTION("Other orders may find another solution") {
+        Puzzle lexicographic(kAmbiguousString);
+        band.SolvePuzzle(lexicographic);
+
+        BandSolver unordered;
+        Puzzle p(kAmbiguousString);
+        REQUIRE(unordered.SolvePuzzle(p));
+        REQUIRE(p.ToString() >= lexicographic.ToString());
+    }
+}
+
+TEST_CASE("Band solver runs batches through the engine interface", "[band]") {
+    BandSolver band;
+    Engine &engine = band;
+    std::vector<Puzzle> puzzles{Puzzle(kEasyString), Puzzle(kConflictingString),
+                                Puzzle(kHardString)};
+
+    REQUIRE(engine.SolvePuzzles(puzzles) == std::vector<bool>{true, false, true});
+    REQUIRE(puzzles[0].IsComplete());
+    REQUIRE(puzzles[2].IsComplete());
+}
+
+TEST_CASE("Band solver gives up at its node limit", "[band]") {
+    BandSolver band;
+    Puzzle p(kHardString);
+    REQUIRE(band.SolvePuzzle(p));
+    const std::uint64_t needed = band.LastNodes();
+    REQUIRE(needed > 1);
+    REQUIRE_FALSE(band.LastBudgetExhausted());
+
+    band.SetNodeLimit(1);
+    Puzzle limited(kHardString);
+    REQUIRE_FALSE(band.SolvePuzzle(limited));
+    REQUIRE(band.LastBudgetExhausted());
+    REQUIRE(limited.ToString() == Puzzle(kHardString).ToString());
+
+    band.SetNodeLimit(needed);
+    Puzzle enough(kHardString);
+    REQUIRE(band.SolvePuzzle(enough));
+    REQUIRE_FALSE(band.LastBudgetExhausted());
+}
+
+TEST_CASE("Band solver triages puzzles without guessing", "[band]") {
+    BandSolver band;
+
+    SECTION("Puzzles propagation finishes are solved") {
+        Puzzle easy(kEasyString);
+        TriageReport report = band.Triage(easy);
+        REQUIRE(report.result == TriageResult::kSolved);
+        REQUIRE(report.hardness == 0);
+        REQUIRE(easy.IsComplete());
+
+        Puzzle solved(kEasyString);
+        REQUIRE(band.SolvePuzzle(solved));
+        REQUIRE(easy.ToString() == solved.ToString());
+    }
+
+    SECTION("Puzzles that need guessing are left alone") {
+        Puzzle hard(kHardString);
+        TriageReport report = band.Triage(hard);
+        REQUIRE(report.result == TriageResult::kNeedsSearch);
+        REQUIRE(report.hardness > 0);
+        REQUIRE(hard.ToString() == kHardString);
+
+        // the propagated board finishes the same search
+        BandSolver::State propagated;
+        Puzzle searched(kHardString);
+        band.Triage(searched, &propagated);
+        REQUIRE(band.SolvePropagated(propagated, searched));
+        const std::uint64_t guesses = band.GuessCount();
+
+        Puzzle solved(kHardString);
+        REQUIRE(band.SolvePuzzle(solved));
+        REQUIRE(searched.ToString() == solved.ToString());
+        REQUIRE(band.GuessCount() == guesses);
+
+        // an empty board is about as far from solved as it gets
+        Puzzle empty;
+        REQUIRE(band.Triage(empty).hardness > report.hardness);
+    }
+
+    SECTION("Contradictions are unsolvable") {
+        Puzzle conflicting(kConflictingString);
+        REQUIRE(band.Triage(conflicting).result == TriageResult::kUnsolvable);
+
+        // the last cell of the first row has no candidates left
+        const std::string dead_end =
+            "12345678_________9_______________________________________________________________";
+        Puzzle puzzle(dead_end);
+        REQUIRE(band.Triage(puzzle).result == TriageResult::kUnsolvable);
+        REQUIRE(puzzle.ToString() == dead_end);
+    }
+}
@@ -0,0 +1,286 @@
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "batcher.h"
+#include "catch.hpp"
+#include "solver.h"
+
+using namespace Sudoku;
+
+namespace {
+const std::string kPuzzleString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______6___";
+
+const std::string kConflictingString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
+}  // namespace
+
+TEST_CASE("Batcher solves every submitted puzzle", "[batcher]") {
+    BatchOptions options;
+    options.max_batch_size = 8;
+    SolveBatcher batcher("band", 3, options);
+
+    std::vector<SolveRequest> requests(40);
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        requests[i].puzzle = Puzzle(i % 4 == 3 ? kConflictingString : kPuzzleString);
+    }
+
+    // submitted from several threads at once
+    Completion completion(requests.size());
+    std::vector<std::thread> clients;
+    for (std::size_t client = 0; client < 4; ++client) {
+        clients.emplace_back([&, client] {
+            for (std::size_t i = client; i < requests.size(); i += 4) {
+                batcher.Submit(&requests[i], &completion);
+            }
+        });
+    }
+    for (auto &client : clients) {
+        client.join();
+    }
+    completion.Wait();
+
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        REQUIRE(requests[i].solved == (i % 4 != 3));
+        REQUIRE(requests[i].puzzle.IsComplete() == (i % 4 != 3));
+    }
+    REQUIRE(batcher.BatchCount() >= 5);
+}
+
+TEST_CASE("Batches wait to fill up", "[batcher]") {
+    BatchOptions options;
+    options.max_batch_size = 4;
+    options.max_wait = std::chrono::seconds(30);
+    SolveBatcher batcher("backtrack", 2, options);
+
+    std::vector<SolveRequest> requests(16);
+    Completion completion(requests.size());
+    for (auto &request : requests) {
+        request.puzzle = Puzzle(kPuzzleString);
+        batcher.Submit(&request, &completion);
+    }
+    completion.Wait();
+
+    REQUIRE(batcher.BatchCount() == 4);
+}
+
+TEST_CASE("Partial batches go out after the wait", "[batcher]") {
+    BatchOptions options;
+    options.max_batch_size = 100;
+    options.max_wait = std::chrono::milliseconds(1);
+    SolveBatcher batcher("band", 1, options);
+
+    SolveRequest request;
+    request.puzzle = Puzzle(kPuzzleString);
+    Completion completion(1);
+    batcher.Submit(&request, &completion);
+    completion.Wait();
+
+    REQUIRE(request.solved);
+    REQUIRE(batcher.BatchCount() == 1);
+}
+
+TEST_CASE("Triage finishes easy puzzles and starts the hardest first", "[batcher]") {
+    const std::string needs_search =
+        "3___28_144_______2__5___89_2_74______31_8______8__1_______527_______6__3_9__3__2_";
+    const std::string empty(kTotalBoardSize, kUnassignedChar);
+    const std::vector<std::string> puzzles{needs_search, kPuzzleString, empty,
+                                           kConflictingString};
+
+    BatchOptions options;
+    options.max_batch_size = puzzles.size();
+    options.max_wait = std::chrono::seconds(30);
+    SolveBatcher batcher("band", 1, options);
+
+    // each request's callback notes when it finished, then counts down all
+    std::mutex mutex;
+    std::vector<std::size_t> finished;
+    Completion all(puzzles.size());
+    std::vector<SolveRequest> requests(puzzles.size());
+    std::vector<std::unique_ptr<Completion>> completions;
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        requests[i].puzzle = Puzzle(puzzles[i]);
+        completions.emplace_back(new Completion(1, [&, i] {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(i);
+            }
+            all.Done();
+        }));
+    }
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        batcher.Submit(&requests[i], completions[i].get());
+    }
+    all.Wait();
+
+    REQUIRE(requests[0].solved);
+    REQUIRE(requests[1].solved);
+    REQUIRE(requests[2].solved);
+    REQUIRE_FALSE(requests[3].solved);
+    REQUIRE(batcher.Stats().triaged == 2);
+    REQUIRE(batcher.Metrics().Collect().solved == 2);
+
+    // triage finishes its two first, then the lone worker takes the empty
+    // board before the puzzle submitted ahead of it
+    REQUIRE(finished == std::vector<std::size_t>{1, 3, 2, 0});
+}
+
+TEST_CASE("Batcher rejects unknown engines", "[batcher]") {
+    REQUIRE_THROWS_AS(SolveBatcher("magic", 1, BatchOptions()), std::invalid_argument);
+}
+
+TEST_CASE("Deterministic batches answer the same whatever the workers", "[batcher]") {
+    // several solutions each
+    const std::vector<std::string> ambiguous{
+        std::string(81, '_'),
+        "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5__________",
+        "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9_______"};
+
+    std::vector<std::string> expected;
+    Solver reference;
+    reference.SetLexicographic(true);
+    for (const auto &string : ambiguous) {
+        Puzzle p(string);
+        REQUIRE(reference.SolvePuzzle(p));
+        expected.push_back(p.ToString());
+    }
+
+    BatchOptions options;
+    options.max_batch_size = 5;
+    options.deterministic = true;
+
+    for (const std::string engine : {"band", "backtrack", "lockstep"}) {
+        for (const unsigned threads : {1u, 4u}) {
+            SolveBatcher batcher(engine, threads, options);
+
+            std::vector<SolveRequest> requests(30);
+            Completion completion(requests.size());
+            for (std::size_t i = 0; i < requests.size(); ++i) {
+                requests[i].puzzle = Puzzle(ambiguous[i % ambiguous.size()]);
+                batcher.Submit(&requests[i], &completion);
+            }
+            completion.Wait();
+
+            // answers come back in submission order
+            for (std::size_t i = 0; i < requests.size(); ++i) {
+                REQUIRE(requests[i].solved);
+                REQUIRE(requests[i].puzzle.ToString() == expected[i % ambiguous.size()]);
+            }
+        }
+    }
+
+    SECTION("Engines without an order are refused") {
+        REQUIRE_THROWS_AS(SolveBatcher("sat", 1, options), std::invalid_argument);
+
+        options.shed_policy = ShedPolicy::kDegrade;
+        options.degrade_engine = "sat";
+        REQUIRE_THROWS_AS(SolveBatcher("band", 1, options), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Batcher sheds puzzles past its pending limit", "[batcher]") {
+    BatchOptions options;
+    options.max_pending = 4;
+    // nothing is dispatched until the batcher is destroyed
+    options.max_wait = std::chrono::seconds(30);
+
+    std::vector<SolveRequest> requests(10);
+    for (auto &request : requests) {
+        request.puzzle = Puzzle(kPuzzleString);
+    }
+    Completion completion(requests.size());
+    BatcherStats stats;
+
+    SECTION("Reject sheds the newest puzzles") {
+        options.shed_policy = ShedPolicy::kReject;
+        {
+            SolveBatcher batcher("band", 2, options);
+            for (auto &request : requests) {
+                batcher.Submit(&request, &completion);
+            }
+            stats = batcher.Stats();
+        }
+        completion.Wait();
+
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            REQUIRE(requests[i].shed == (i >= 4));
+            REQUIRE(requests[i].solved == (i < 4));
+        }
+        REQUIRE(stats.queued == 4);
+        REQUIRE(stats.pending == 4);
+        REQUIRE(stats.peak_pending == 4);
+        REQUIRE(stats.admitted == 4);
+        REQUIRE(stats.rejected == 6);
+    }
+
+    SECTION("Drop oldest sheds the longest queued puzzles") {
+        options.shed_policy = ShedPolicy::kDropOldest;
+        {
+            SolveBatcher batcher("band", 2, options);
+            for (auto &request : requests) {
+                batcher.Submit(&request, &completion);
+            }
+            stats = batcher.Stats();
+        }
+        completion.Wait();
+
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            REQUIRE(requests[i].shed == (i < 6));
+            REQUIRE(requests[i].solved == (i >= 6));
+        }
+        REQUIRE(stats.queued == 4);
+        REQUIRE(stats.admitted == 10);
+        REQUIRE(stats.dropped == 6);
+    }
+
+    SECTION("Degrade solves the overflow on the submitting thread") {
+        options.shed_policy = ShedPolicy::kDegrade;
+        options.degrade_engine = "band";
+        options.degrade_node_limit = 1000;
+        {
+            SolveBatcher batcher("backtrack", 2, options);
+            for (auto &request : requests) {
+                batcher.Submit(&request, &completion);
+            }
+            stats = batcher.Stats();
+        }
+        completion.Wait();
+
+        for (auto &request : requests) {
+            REQUIRE_FALSE(request.shed);
+            REQUIRE(request.solved);
+        }
+        REQUIRE(stats.degraded == 6);
+    }
+
+    SECTION("Degraded puzzles are shed when the node limit runs out") {
+        options.shed_policy = ShedPolicy::kDegrade;
+        options.degrade_engine = "backtrack";
+        options.degrade_node_limit = 1;
+        {
+            SolveBatcher batcher("band", 2, options);
+            for (auto &request : requests) {
+                batcher.Submit(&request, &completion);
+            }
+        }
+        completion.Wait();
+
+        for (std::size_t i = 0; i < requests.size(); ++i) {
+            REQUIRE(requests[i].shed == (i >= 4));
+            REQUIRE(requests[i].puzzle.IsComplete() == (i < 4));
+        }
+    }
+}
+
+TEST_CASE("Batcher rejects unknown shed policies", "[batcher]") {
+    REQUIRE(ParseShedPolicy("drop-oldest") == ShedPolicy::kDropOldest);
+    REQUIRE_THROWS_AS(ParseShedPolicy("panic"), std::invalid_argument);
+
+    BatchOptions options;
+    options.shed_policy = ShedPolicy::kDegrade;
+    options.degrade_engine = "magic";
+    REQUIRE_THROWS_AS(SolveBatcher("band", 1, options), std::invalid_argument);
+}
@@ -0,0 +1,83 @@
+#include "candidates.h"
+#include "catch.hpp"
+#include "puzzle.h"
+
+#include <array>
+
+using namespace Sudoku;
+
+namespace {
+const std::string kSudokuString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5___"
+    "___6___";
+
+const std::string kSudoku16String =
+    "__F___C_31___4_7_6_831____B_D_F_31_AG__7DE__5_C____7DEF2_6_____A_F25________4B7D6C83_9A_"
+    "4B_____51_AG4__D______834B7DE_2__C8_1_A______8_1_AG4B7D___31_A____DE_25_9_G4B__E___6C_31B__"
+    "___56____9A__25_C8__9_G_B___F8_1__G4_7DEF25__AG4_7_E__5__8_____E_2__C8___A___";
+
+// Checks every kernel against the puzzle's own per-cell candidates
+template <int BoxSize>
+void CheckKernels(const BasicPuzzle<BoxSize> &puzzle) {
+    using Geometry = BoardGeometry<BoxSize>;
+
+    std::array<std::uint8_t, Geometry::kTotalBoardSize + kCandidatePadding> cells{};
+    std::array<typename Geometry::Mask_t, Geometry::kUnitCount + kUnitMaskPadding> unit_masks{};
+
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        int value = puzzle.GetCell(cell);
+        cells[cell] = static_cast<std::uint8_t>(value);
+
+        if (value != kUnassigned) {
+            unit_masks[Geometry::kRowOf[cell]] |= Geometry::ValueBit(value);
+            unit_masks[Geometry::kBoardSize + Geometry::kColumnOf[cell]] |=
+                Geometry::ValueBit(value);
+            unit_masks[2 * Geometry::kBoardSize + Geometry::kBoxOf[cell]] |=
+                Geometry::ValueBit(value);
+        }
+    }
+
+    for (CandidateKernel kernel :
+         {CandidateKernel::kScalar, CandidateKernel::kSse4, CandidateKernel::kAvx2}) {
+        CAPTURE(CandidateKernelName(kernel));
+        CandidateTable<BoxSize> table;
+        ComputeCandidates<BoxSize>(kernel, cells.data(), unit_masks.data(), table);
+
+        for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+            CAPTURE(cell);
+            if (puzzle.GetCell(cell) == kUnassigned) {
+                REQUIRE(table[cell] == puzzle.Candidates(cell));
+            } else {
+                REQUIRE(table[cell] == 0);
+            }
+        }
+    }
+
+    CandidateTable<BoxSize> table;
+    puzzle.AllCandidates(table);
+    for (int cell = 0; cell < Geometry::kTotalBoardSize; ++cell) {
+        if (puzzle.GetCell(cell) == kUnassigned) {
+            REQUIRE(table[cell] == puzzle.Candidates(cell));
+        }
+    }
+}
+}  // namespace
+
+TEST_CASE("Candidate kernels agree with the per-cell candidates", "[candidates]") {
+    SECTION("9x9 board") { CheckKernels(Puzzle(kSudokuString)); }
+
+    SECTION("Empty 9x9 board") { CheckKernels(Puzzle()); }
+
+    SECTION("16x16 board") { CheckKernels(Puzzle16(kSudoku16String)); }
+
+    SECTION("25x25 board uses the scalar kernel") {
+        Puzzle25 puzzle;
+        puzzle.Set(0, 0, 25);
+        puzzle.Set(24, 24, 1);
+        CheckKernels(puzzle);
+    }
+}
+
+TEST_CASE("Candidate kernels have names", "[candidates]") {
+    REQUIRE(std::string(CandidateKernelName(DetectCandidateKernel())).size() > 0);
+}
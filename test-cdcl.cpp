@@ -0,0 +1,88 @@
+#include "catch.hpp"
+#include "cdcl.h"
+
+using namespace Sudoku;
+
+namespace {
+// Adds clauses saying the pigeons each sit in one of the holes and no hole
+// holds two pigeons. Returns the variable of pigeon p in hole h at p * holes + h.
+void AddPigeonhole(CdclSolver &solver, const int pigeons, const int holes) {
+    for (int i = 0; i < pigeons * holes; ++i) {
+        solver.NewVariable();
+    }
+
+    for (int p = 0; p < pigeons; ++p) {
+        std::vector<CdclSolver::Literal> clause;
+        for (int h = 0; h < holes; ++h) {
+            clause.push_back(CdclSolver::Positive(p * holes + h));
+        }
+        solver.AddClause(clause);
+    }
+
+    for (int h = 0; h < holes; ++h) {
+        for (int p = 0; p < pigeons; ++p) {
+            for (int q = p + 1; q < pigeons; ++q) {
+                solver.AddClause({CdclSolver::Negative(p * holes + h),
+                                  CdclSolver::Negative(q * holes + h)});
+            }
+        }
+    }
+}
+}  // namespace
+
+TEST_CASE("CDCL solver finds models", "[cdcl]") {
+    CdclSolver solver;
+    int a = solver.NewVariable();
+    int b = solver.NewVariable();
+    int c = solver.NewVariable();
+
+    REQUIRE(solver.AddClause({CdclSolver::Positive(a), CdclSolver::Positive(b)}));
+    REQUIRE(solver.AddClause({CdclSolver::Negative(a), CdclSolver::Positive(c)}));
+    REQUIRE(solver.AddClause({CdclSolver::Negative(b)}));
+
+    REQUIRE(solver.Solve() == CdclSolver::Result::kSatisfiable);
+    REQUIRE(solver.ModelValue(a));
+    REQUIRE_FALSE(solver.ModelValue(b));
+    REQUIRE(solver.ModelValue(c));
+}
+
+TEST_CASE("CDCL solver proves unsatisfiability", "[cdcl]") {
+    CdclSolver solver;
+
+    SECTION("Contradicting unit clauses") {
+        int a = solver.NewVariable();
+        REQUIRE(solver.AddClause({CdclSolver::Positive(a)}));
+        REQUIRE_FALSE(solver.AddClause({CdclSolver::Negative(a)}));
+        REQUIRE(solver.Solve() == CdclSolver::Result::kUnsatisfiable);
+    }
+
+    SECTION("Pigeonhole needs learning") {
+        AddPigeonhole(solver, 6, 5);
+        REQUIRE(solver.Solve() == CdclSolver::Result::kUnsatisfiable);
+        REQUIRE(solver.Conflicts() > 0);
+    }
+
+    SECTION("Conflict limits give up") {
+        AddPigeonhole(solver, 9, 8);
+        REQUIRE(solver.Solve(10) == CdclSolver::Result::kUnknown);
+    }
+}
+
+TEST_CASE("CDCL solver can be reset", "[cdcl]") {
+    CdclSolver solver;
+    AddPigeonhole(solver, 4, 3);
+    REQUIRE(solver.Solve() == CdclSolver::Result::kUnsatisfiable);
+
+    solver.Reset();
+    REQUIRE(solver.VariableCount() == 0);
+    AddPigeonhole(solver, 4, 4);
+    REQUIRE(solver.Solve() == CdclSolver::Result::kSatisfiable);
+
+    for (int h = 0; h < 4; ++h) {
+        int pigeons = 0;
+        for (int p = 0; p < 4; ++p) {
+            pigeons += solver.ModelValue(p * 4 + h) ? 1 : 0;
+        }
+        REQUIRE(pigeons == 1);
+    }
+}
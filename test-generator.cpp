@@ -4,10 +4,13 @@
 #include <iterator>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include "band_solver.h"
 #include "catch.hpp"
 #include "generator.h"
+#include "logic_solver.h"
 
 using namespace Sudoku;
 using Catch::Matchers::EndsWith;
@@ -101,4 +104,95 @@ TEST_CASE("GetPuzzleSourceFromUser gets correct source") {
         REQUIRE_THAT(output, StartsWith("Please enter a filename") &&
                                  !EndsWith("Please enter in a sudoku puzzle.\n"));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("GeneratePuzzles makes minimal unique puzzles", "[generator]") {
+    Generator generator;
+    BandSolver counter;
+    GenerationOptions options;
+    options.seed = 42;
+
+    std::vector<Puzzle> puzzles = generator.GeneratePuzzles(4, options);
+    REQUIRE(puzzles.size() == 4);
+
+    for (auto& puzzle : puzzles) {
+        REQUIRE(puzzle.IsValid());
+        REQUIRE(counter.CountSolutions(puzzle, 2) == 1);
+
+        // every clue is needed
+        for (int cell = 0; cell < puzzle.Size(); ++cell) {
+            const int value = puzzle.GetCell(cell);
+            if (value != kUnassigned) {
+                Puzzle reduced = puzzle;
+                reduced.Unassign(cell);
+                REQUIRE(counter.CountSolutions(reduced, 2) == 2);
+            }
+        }
+    }
+
+    REQUIRE(puzzles[0].ToString() != puzzles[1].ToString());
+}
+
+TEST_CASE("GeneratePuzzles is deterministic", "[generator]") {
+    Generator generator;
+    GenerationOptions options;
+    options.seed = 7;
+
+    std::vector<Puzzle> single = generator.GeneratePuzzles(6, options);
+    options.threads = 3;
+    std::vector<Puzzle> threaded = generator.GeneratePuzzles(6, options);
+
+    for (std::size_t i = 0; i < single.size(); ++i) {
+        REQUIRE(single[i].ToString() == threaded[i].ToString());
+    }
+    REQUIRE(Generator::GeneratePuzzle(4, options).ToString() == single[4].ToString());
+
+    options.seed = 8;
+    REQUIRE(generator.GeneratePuzzles(1, options)[0].ToString() != single[0].ToString());
+
+    // and on every platform
+    options.seed = 2024;
+    REQUIRE(Generator::GeneratePuzzle(0, options).ToString() ==
+            "9____________5___1376_________4_2__874__36_________1___5_____67__46____9____15__3");
+}
+
+TEST_CASE("GeneratePuzzles respects the difficulty range", "[generator]") {
+    Generator generator;
+    LogicSolver rater;
+    GenerationOptions options;
+    options.seed = 3;
+    options.threads = 2;
+    options.min_difficulty = 2.6;
+    options.max_difficulty = 4.5;
+
+    for (auto& puzzle : generator.GeneratePuzzles(4, options)) {
+        const LogicReport& report = rater.Rate(puzzle);
+        REQUIRE(report.solved);
+        REQUIRE(report.difficulty >= 2.6);
+        REQUIRE(report.difficulty <= 4.5);
+    }
+
+    SECTION("Impossible ranges throw") {
+        options.min_difficulty = 20.0;
+        options.max_difficulty = 30.0;
+        options.max_attempts = 2;
+        REQUIRE_THROWS_AS(generator.GeneratePuzzles(1, options), std::runtime_error);
+    }
+}
+
+TEST_CASE("ReadPuzzles reads SPF streams", "[generator]") {
+    std::istringstream input("# spf1.0\n" + kSudokuString + "\r\n\n# comment\n" + kSudokuString +
+                             "\n");
+    std::vector<Puzzle> puzzles = Generator::ReadPuzzles(input);
+    REQUIRE(puzzles.size() == 2);
+    REQUIRE(puzzles[1].ToString() == kSudokuString);
+
+    std::istringstream bad("# spf1.0\n" + kSudokuString + "\n12345\n");
+    REQUIRE_THROWS_WITH(Generator::ReadPuzzles(bad), StartsWith("Line 3: "));
+
+    SECTION("The bundled corpus is readable") {
+        std::ifstream corpus("corpus.spf");
+        if (corpus) {
+            REQUIRE(Generator::ReadPuzzles(corpus).size() == 800);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "catch.hpp"
+#include "geometry.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace Sudoku;
+
+using Geometry9 = BoardGeometry<3>;
+using Geometry16 = BoardGeometry<4>;
+
+// The tables are usable in constant expressions
+static_assert(Geometry9::kPeerCount == 20, "9x9 cells have 20 peers");
+static_assert(Geometry16::kPeerCount == 39, "16x16 cells have 39 peers");
+static_assert(Geometry9::kBoxOf[80] == 8, "last cell lives in the last box");
+static_assert(Geometry9::kPeers[0][0] == 1, "first peer is the next cell in the row");
+
+TEST_CASE("Geometry tables describe the 9x9 board", "[geometry]") {
+    SECTION("Row, column and box indices") {
+        REQUIRE(Geometry9::kRowOf[40] == 4);
+        REQUIRE(Geometry9::kColumnOf[40] == 4);
+        REQUIRE(Geometry9::kBoxOf[40] == 4);
+        REQUIRE(Geometry9::kBoxOf[29] == 3);
+        REQUIRE(Geometry9::kBoxOf[60] == 8);
+    }
+
+    SECTION("Peers are exactly the cells sharing a unit") {
+        for (int cell = 0; cell < Geometry9::kTotalBoardSize; ++cell) {
+            std::set<int> expected;
+            for (int other = 0; other < Geometry9::kTotalBoardSize; ++other) {
+                if (other != cell && (Geometry9::kRowOf[other] == Geometry9::kRowOf[cell] ||
+                                      Geometry9::kColumnOf[other] == Geometry9::kColumnOf[cell] ||
+                                      Geometry9::kBoxOf[other] == Geometry9::kBoxOf[cell])) {
+                    expected.insert(other);
+                }
+            }
+
+            std::set<int> peers(Geometry9::kPeers[cell].begin(), Geometry9::kPeers[cell].end());
+            REQUIRE(peers == expected);
+        }
+    }
+
+    SECTION("Units list their cells") {
+        for (int unit = 0; unit < Geometry9::kUnitCount; ++unit) {
+            for (int cell : Geometry9::kUnits[unit]) {
+                if (unit < Geometry9::kBoardSize) {
+                    REQUIRE(Geometry9::kRowOf[cell] == unit);
+                } else if (unit < 2 * Geometry9::kBoardSize) {
+                    REQUIRE(Geometry9::kColumnOf[cell] == unit - Geometry9::kBoardSize);
+                } else {
+                    REQUIRE(Geometry9::kBoxOf[cell] == unit - 2 * Geometry9::kBoardSize);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Geometry tables scale to larger boards", "[geometry]") {
+    for (int cell = 0; cell < Geometry16::kTotalBoardSize; ++cell) {
+        const auto &peers = Geometry16::kPeers[cell];
+        std::set<int> unique_peers(peers.begin(), peers.end());
+
+        REQUIRE(unique_peers.size() == peers.size());
+        REQUIRE(unique_peers.count(cell) == 0);
+    }
+
+    REQUIRE(sizeof(Geometry16::Mask_t) == 2);
+    REQUIRE(sizeof(BoardGeometry<5>::Mask_t) == 4);
+}
@@ -0,0 +1,42 @@
+#include <set>
+
+#include "catch.hpp"
+#include "grid_sampler.h"
+
+using namespace Sudoku;
+
+TEST_CASE("Grid sampler produces valid complete grids", "[sampler]") {
+    GridSampler sampler(1, 4, 8);
+    std::set<std::string> grids;
+
+    for (int i = 0; i < 200; ++i) {
+        Puzzle grid = (i % 2 == 0) ? sampler.Sample() : sampler.SampleFresh();
+        REQUIRE(grid.IsComplete());
+        REQUIRE(grid.IsValid());
+        grids.insert(grid.ToString());
+    }
+
+    REQUIRE(grids.size() == 200);
+}
+
+TEST_CASE("Grid sampler is reproducible from its seed", "[sampler]") {
+    GridSampler first(99);
+    GridSampler second(99);
+    GridSampler other(100);
+
+    GridSampler::Grid a;
+    GridSampler::Grid b;
+    for (int i = 0; i < 100; ++i) {
+        first.Sample(a);
+        second.Sample(b);
+        REQUIRE(a == b);
+    }
+
+    first.Seed(5);
+    other.Seed(5);
+    REQUIRE(first.SampleFresh().ToString() == other.SampleFresh().ToString());
+    REQUIRE(first.Sample().ToString() == other.Sample().ToString());
+
+    first.Seed(6);
+    REQUIRE(first.SampleFresh().ToString() != second.SampleFresh().ToString());
+}
@@ -0,0 +1,125 @@
+#include "band_solver.h"
+#include "catch.hpp"
+#include "generator.h"
+#include "lockstep_solver.h"
+#include "metrics.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Sudoku;
+
+namespace {
+// Solved by singles alone
+const std::string kEasyString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______6___";
+
+// Needs guessing to solve
+const std::string kHardString =
+    "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9____4__";
+
+const std::string kConflictingString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
+
+// No conflicting givens, but the top right cell has no value left
+const std::string kDeadEndString =
+    "12345678_________9_______________________________________________________________";
+
+// Every kind of puzzle, in a batch that doesn't fill its last group
+std::vector<Puzzle> MixedBatch() {
+    std::vector<Puzzle> puzzles;
+    for (int i = 0; i < LockstepSolver::kLanes + 3; ++i) {
+        switch (i % 4) {
+            case 0:
+                puzzles.emplace_back(kEasyString);
+                break;
+            case 1:
+                puzzles.emplace_back(kHardString);
+                break;
+            case 2:
+                puzzles.emplace_back(kConflictingString);
+                break;
+            default:
+                puzzles.emplace_back(kDeadEndString);
+                break;
+        }
+    }
+    return puzzles;
+}
+}  // namespace
+
+TEST_CASE("Lockstep solver matches the band solver", "[lockstep]") {
+    LockstepSolver lockstep;
+    REQUIRE(std::string(lockstep.Name()) == "lockstep");
+
+    std::vector<Puzzle> puzzles = MixedBatch();
+    std::vector<Puzzle> expected = puzzles;
+
+    std::vector<bool> solved = lockstep.SolvePuzzles(puzzles);
+    BandSolver band;
+    std::vector<bool> expected_solved = band.SolvePuzzles(expected);
+
+    REQUIRE(solved == expected_solved);
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        REQUIRE(puzzles[i].ToString() == expected[i].ToString());
+    }
+
+    // only the puzzles that need guessing leave the lanes
+    std::size_t hard = 0;
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        hard += (i % 4 == 1) ? 1 : 0;
+    }
+    REQUIRE(lockstep.LastFallbacks() == hard);
+}
+
+TEST_CASE("Lockstep solver solves single puzzles", "[lockstep]") {
+    LockstepSolver lockstep;
+
+    Puzzle hard(kHardString);
+    REQUIRE(lockstep.SolvePuzzle(hard));
+    REQUIRE(hard.IsComplete());
+    REQUIRE(lockstep.LastNodes() > 0);
+
+    Puzzle conflicting(kConflictingString);
+    REQUIRE_FALSE(lockstep.SolvePuzzle(conflicting));
+}
+
+TEST_CASE("Lockstep solver records every puzzle of a batch", "[lockstep]") {
+    EngineMetrics metrics("lockstep", 1);
+    LockstepSolver lockstep;
+    lockstep.AttachMetrics(&metrics, 0);
+
+    std::vector<Puzzle> puzzles{Puzzle(kEasyString), Puzzle(kHardString),
+                                Puzzle(kConflictingString)};
+    lockstep.SolvePuzzles(puzzles);
+
+    EngineMetrics::Totals totals = metrics.Collect();
+    REQUIRE(totals.solved == 2);
+    REQUIRE(totals.unsolved == 1);
+}
+
+TEST_CASE("Lockstep solver is made by name", "[lockstep]") {
+    std::unique_ptr<Engine> engine = MakeEngine("lockstep");
+    REQUIRE(engine);
+    REQUIRE(std::string(engine->Name()) == "lockstep");
+}
+
+TEST_CASE("Lockstep solver solves the corpus like the band solver", "[lockstep][corpus]") {
+    std::ifstream corpus("corpus.spf");
+    if (!corpus) {
+        return;
+    }
+
+    std::vector<Puzzle> puzzles = Generator::ReadPuzzles(corpus);
+    std::vector<Puzzle> expected = puzzles;
+
+    LockstepSolver lockstep;
+    BandSolver band;
+    REQUIRE(lockstep.SolvePuzzles(puzzles) == band.SolvePuzzles(expected));
+    for (std::size_t i = 0; i < puzzles.size(); ++i) {
+        REQUIRE(puzzles[i].ToString() == expected[i].ToString());
+    }
+    REQUIRE(lockstep.LastFallbacks() < puzzles.size());
+}
@@ -0,0 +1,87 @@
+#include "band_solver.h"
+#include "catch.hpp"
+#include "logic_solver.h"
+
+using namespace Sudoku;
+
+namespace {
+struct RatedPuzzle {
+    std::string puzzle;
+    Technique hardest;
+};
+
+const RatedPuzzle kRatedPuzzles[] = {
+    {"_____51_____4_8__61__6___87_____2_____2___6_5376____1_____8____59____47_____3____",
+     Technique::kHiddenSingle},
+    {"____12___749_____6__8_7____3__8___92______84__8__26____7__83_5____5____1_1___7___",
+     Technique::kNakedSingle},
+    {"___6__1________2_3_89_4________854__4_5_76__2_71__________6__3___35______9___4__8",
+     Technique::kLockedCandidates},
+    {"1___4__3___8__3__9__3_7___8___71_8___5___421_7_______6_4_2_7____1_____5_8_6_____4",
+     Technique::kXWing},
+    {"___________3___7__26_5___1____7_6___1___4___3_9____4___1__6__5_4_781__6___9_3___7",
+     Technique::kSwordfish},
+    {"__2_8_6_4_____7___6__1___8___58___3___6_45___9__31_4_____5_8_9_______5_2___49_1__",
+     Technique::kXYWing},
+    {"____4_2___7_5___3____67__59__9_6_____2____4_6_851___2_3__4_57____1_______9__8_5__",
+     Technique::kColoring},
+    {"3___28_144_______2__5___89_2_74______31_8______8__1_______527_______6__3_9__3__2_",
+     Technique::kXYChain},
+};
+
+// Unique, but beyond the techniques the solver knows
+const std::string kGuessingString =
+    "_5__4____8__2___7__29__65_______7_93______6_________24__1_6____94__28__6___7____9";
+}  // namespace
+
+TEST_CASE("Logic solver rates puzzles by their hardest technique", "[logic]") {
+    LogicSolver logic;
+    BandSolver band;
+
+    for (const auto &rated : kRatedPuzzles) {
+        Puzzle p(rated.puzzle);
+        Puzzle expected(rated.puzzle);
+        REQUIRE(band.SolvePuzzle(expected));
+
+        REQUIRE(logic.SolvePuzzle(p));
+        REQUIRE(p.ToString() == expected.ToString());
+
+        const LogicReport &report = logic.LastReport();
+        REQUIRE(report.solved);
+        REQUIRE(report.Used(rated.hardest));
+        REQUIRE(report.difficulty == Approx(TechniqueDifficulty(rated.hardest)));
+    }
+}
+
+TEST_CASE("Logic solver leaves puzzles it can't finish alone", "[logic]") {
+    LogicSolver logic;
+
+    SECTION("Puzzles needing guesses") {
+        Puzzle p(kGuessingString);
+        REQUIRE_FALSE(logic.SolvePuzzle(p));
+        REQUIRE(p.ToString() == Puzzle(kGuessingString).ToString());
+        REQUIRE_FALSE(logic.LastReport().solved);
+        REQUIRE(logic.LastReport().difficulty == Approx(kGuessingDifficulty));
+    }
+
+    SECTION("Rating doesn't change the puzzle") {
+        Puzzle p(kRatedPuzzles[0].puzzle);
+        REQUIRE(logic.Rate(p).solved);
+        REQUIRE(p.ToString() == Puzzle(kRatedPuzzles[0].puzzle).ToString());
+    }
+
+    SECTION("Conflicting puzzles") {
+        Puzzle p("___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__");
+        REQUIRE_FALSE(logic.SolvePuzzle(p));
+    }
+}
+
+TEST_CASE("Technique names and difficulties", "[logic]") {
+    REQUIRE(std::string(TechniqueName(Technique::kXWing)) == "x-wing");
+    REQUIRE(std::string(TechniqueName(Technique::kXYChain)) == "xy-chain");
+
+    for (int t = 1; t < kTechniqueCount; ++t) {
+        REQUIRE(TechniqueDifficulty(static_cast<Technique>(t - 1)) <
+                TechniqueDifficulty(static_cast<Technique>(t)));
+    }
+}
@@ -1,4 +1,7 @@
 #define CATCH_CONFIG_MAIN
+// The bundled Catch sizes its signal stack with SIGSTKSZ, which is no longer a
+// compile-time constant on recent glibc.
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 
 // This file is where it will build the main method for testing.
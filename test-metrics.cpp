@@ -0,0 +1,147 @@
+#include <thread>
+#include <vector>
+
+#include "band_solver.h"
+#include "catch.hpp"
+#include "metrics.h"
+
+using namespace Sudoku;
+
+TEST_CASE("Histogram buckets cover every value", "[metrics]") {
+    SECTION("Small values get a bucket each") {
+        for (std::uint64_t value = 0; value < 32; ++value) {
+            int bucket = HistogramSnapshot::BucketOf(value);
+            REQUIRE(HistogramSnapshot::LowerBound(bucket) == value);
+            REQUIRE(HistogramSnapshot::UpperBound(bucket) == value);
+        }
+    }
+
+    SECTION("Buckets are contiguous and within 6% of their values") {
+        for (int bucket = 1; bucket < HistogramSnapshot::kBucketCount; ++bucket) {
+            REQUIRE(HistogramSnapshot::LowerBound(bucket) ==
+                    HistogramSnapshot::UpperBound(bucket - 1) + 1);
+        }
+        REQUIRE(HistogramSnapshot::UpperBound(HistogramSnapshot::kBucketCount - 1) == ~0ull);
+
+        for (std::uint64_t value : {32ull, 1000ull, 123456789ull, 1ull << 40, ~0ull}) {
+            int bucket = HistogramSnapshot::BucketOf(value);
+            std::uint64_t lower = HistogramSnapshot::LowerBound(bucket);
+            std::uint64_t upper = HistogramSnapshot::UpperBound(bucket);
+            REQUIRE(lower <= value);
+            REQUIRE(value <= upper);
+            REQUIRE(static_cast<double>(upper - lower) <= 0.0625 * static_cast<double>(lower));
+        }
+    }
+}
+
+TEST_CASE("Histograms report counts and quantiles", "[metrics]") {
+    Histogram histogram;
+    for (std::uint64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+
+    HistogramSnapshot snapshot;
+    histogram.AddTo(snapshot);
+    REQUIRE(snapshot.count == 1000);
+    REQUIRE(snapshot.sum == 500500);
+    REQUIRE(snapshot.CountAtMost(0) == 0);
+    REQUIRE(snapshot.CountAtMost(31) == 31);
+    REQUIRE(snapshot.CountAtMost(1000000) == 1000);
+
+    REQUIRE(snapshot.Quantile(0.5) >= 500);
+    REQUIRE(snapshot.Quantile(0.5) <= 500 * 1.0625);
+    REQUIRE(snapshot.Quantile(1.0) >= 1000);
+    REQUIRE(HistogramSnapshot().Quantile(0.5) == 0);
+}
+
+TEST_CASE("Engine metrics merge their shards", "[metrics]") {
+    EngineMetrics metrics("band", 4);
+    REQUIRE(metrics.Engine() == "band");
+    REQUIRE(metrics.Shards() == 4);
+
+    std::vector<std::thread> threads;
+    for (unsigned shard = 0; shard < 4; ++shard) {
+        threads.emplace_back([&metrics, shard] {
+            for (int i = 0; i < 1000; ++i) {
+                metrics.Record(shard, 1000, static_cast<std::uint64_t>(i % 8), i % 4 != 0,
+                               i % 8 == 0);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EngineMetrics::Totals totals = metrics.Collect();
+    REQUIRE(totals.solved == 3000);
+    REQUIRE(totals.unsolved == 1000);
+    REQUIRE(totals.gave_up == 500);
+    REQUIRE(totals.latency.count == 4000);
+    REQUIRE(totals.nodes.CountAtMost(3) == 2000);
+}
+
+TEST_CASE("Engines record solves into attached metrics", "[metrics]") {
+    const std::string kHardString =
+        "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9____4__";
+
+    EngineMetrics metrics("band", 1);
+    BandSolver band;
+    band.AttachMetrics(&metrics, 0);
+
+    std::vector<Puzzle> puzzles{Puzzle(kHardString), Puzzle(kHardString)};
+    band.SolvePuzzles(puzzles);
+
+    Puzzle untracked(kHardString);
+    band.AttachMetrics(nullptr, 0);
+    band.SolvePuzzle(untracked);
+
+    EngineMetrics::Totals totals = metrics.Collect();
+    REQUIRE(totals.solved == 2);
+    REQUIRE(totals.nodes.sum == 2 * band.LastNodes());
+    REQUIRE(totals.latency.sum > 0);
+}
+
+TEST_CASE("Metrics text follows the Prometheus format", "[metrics]") {
+    Histogram histogram;
+    histogram.Record(1);
+    histogram.Record(5);
+    HistogramSnapshot snapshot;
+    histogram.AddTo(snapshot);
+
+    MetricsText page;
+    page.Family("solves_total", "counter", "Puzzles solved.");
+    page.Sample("solves_total", "engine=\"band\"", std::uint64_t{42});
+    page.Sample("ratio", "", 0.5);
+    page.Histogram("nodes", "engine=\"band\"", snapshot, {1, 4}, 1);
+
+    REQUIRE(page.Text() ==
+            "# HELP solves_total Puzzles solved.\n"
+            "# TYPE solves_total counter\n"
+            "solves_total{engine=\"band\"} 42\n"
+            "ratio 0.5\n"
+            "nodes_bucket{engine=\"band\",le=\"1\"} 1\n"
+            "nodes_bucket{engine=\"band\",le=\"4\"} 1\n"
+            "nodes_bucket{engine=\"band\",le=\"+Inf\"} 2\n"
+            "nodes_sum{engine=\"band\"} 6\n"
+            "nodes_count{engine=\"band\"} 2\n");
+}
+
+TEST_CASE("Metrics text counts values equal to a bound under it", "[metrics]") {
+    Histogram histogram;
+    histogram.Record(64);
+    histogram.Record(256);
+    histogram.Record(300);
+    HistogramSnapshot snapshot;
+    histogram.AddTo(snapshot);
+
+    // 64 and 256 share their buckets with a few larger values, so the
+    // bounds move up to those buckets' edges
+    MetricsText page;
+    page.Histogram("nodes", "", snapshot, {64, 256}, 1);
+    REQUIRE(page.Text() ==
+            "nodes_bucket{le=\"67\"} 1\n"
+            "nodes_bucket{le=\"271\"} 2\n"
+            "nodes_bucket{le=\"+Inf\"} 3\n"
+            "nodes_sum 620\n"
+            "nodes_count 3\n");
+}
@@ -0,0 +1,37 @@
+#include "catch.hpp"
+#include "perf_counters.h"
+
+using namespace Sudoku;
+
+TEST_CASE("Perf counters count or explain why not", "[perf]") {
+    PerfCounters counters;
+
+    if (!counters.Available()) {
+        REQUIRE_FALSE(counters.Error().empty());
+
+        counters.Start();
+        PerfSample sample = counters.Stop();
+        for (int event = 0; event < kPerfEventCount; ++event) {
+            REQUIRE_FALSE(sample.available[event]);
+        }
+        return;
+    }
+
+    counters.Start();
+    volatile std::uint64_t sum = 0;
+    for (int i = 0; i < 100000; ++i) {
+        sum = sum + i;
+    }
+    PerfSample sample = counters.Stop();
+
+    REQUIRE(sample.Has(PerfEvent::kCycles));
+    REQUIRE(sample[PerfEvent::kCycles] > 0);
+    if (sample.Has(PerfEvent::kInstructions)) {
+        REQUIRE(sample[PerfEvent::kInstructions] >= 100000);
+    }
+}
+
+TEST_CASE("Perf events have names", "[perf]") {
+    REQUIRE(std::string(PerfEventName(PerfEvent::kInstructions)) == "instructions");
+    REQUIRE(std::string(PerfEventName(PerfEvent::kLastLevelMisses)) == "LLC-misses");
+}
@@ -24,46 +24,49 @@ TEST_CASE("Puzzles can be instantiated and accessed", "[puzzle]") {
         REQUIRE_THAT(puzzle.ToString(), Equals(std::string(kTotalBoardSize, kUnassignedChar)));
     }
 
-    SECTION("[] operator can be used to modify the puzzle") {
-        SECTION("[] can assign a new vector for a row") {
-            puzzle[0] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    SECTION("Set can be used to modify the puzzle") {
+        SECTION("Set can fill a row") {
+            for (int col = 0; col < kBoardSize; ++col) {
+                puzzle.Set(0, col, col + 1);
+            }
 
             REQUIRE(puzzle.Size() == kTotalBoardSize);
-            REQUIRE_THAT(puzzle[0], Equals(PuzzleRow_t{1, 2, 3, 4, 5, 6, 7, 8, 9}));
+            REQUIRE_THAT(puzzle.GetRow(0), Equals(PuzzleRow_t{1, 2, 3, 4, 5, 6, 7, 8, 9}));
         }
 
-        SECTION("[] can add new value to mutable reference") {
-            PuzzleRow_t &test_row = puzzle[0];
-            test_row.push_back(0);
+        SECTION("Assign addresses cells in row-major order") {
+            puzzle.Assign(kBoardSize + 2, 7);
 
-            REQUIRE(puzzle.Size() == kTotalBoardSize + 1);
-            REQUIRE_THAT(puzzle[0], Equals(PuzzleRow_t(kBoardSize + 1, 0)));
+            REQUIRE(puzzle.Get(1, 2) == 7);
+            REQUIRE(puzzle.GetCell(kBoardSize + 2) == 7);
+            REQUIRE(puzzle[1][2] == 7);
         }
 
-        SECTION("[] can directly expand a row") {
-            puzzle[0].push_back(0);
+        SECTION("[] gives read-only access to the cells") {
+            puzzle.Set(4, 5, 3);
 
-            REQUIRE(puzzle.Size() == kTotalBoardSize + 1);
-            REQUIRE_THAT(puzzle[0], Equals(PuzzleRow_t(kBoardSize + 1, 0)));
+            REQUIRE(puzzle[4][5] == 3);
+            REQUIRE(puzzle[4][4] == kUnassigned);
         }
     }
 
     SECTION("Column accessor returns columns correctly") {
-        for (unsigned int i = 0; i < kBoardSize; ++i) {
-            puzzle[i][4] = i;
+        for (int i = 0; i < kBoardSize; ++i) {
+            puzzle.Set(i, 4, i);
         }
 
         REQUIRE_THAT(puzzle.GetColumn(4), Equals(PuzzleRow_t{0, 1, 2, 3, 4, 5, 6, 7, 8}));
     }
 
     SECTION("Row accessor returns rows correctly") {
-        puzzle[0] = PuzzleRow_t(kBoardSize, 5);
-        REQUIRE_THAT(puzzle.GetRow(0), Equals(PuzzleRow_t(kBoardSize, 5)));
+        puzzle.Set(0, 3, 5);
+        puzzle.Set(0, 8, 2);
+        REQUIRE_THAT(puzzle.GetRow(0), Equals(PuzzleRow_t{0, 0, 0, 5, 0, 0, 0, 0, 2}));
     }
 
     SECTION("Puzzle can be instatiated with a board") {
         Puzzle filled_puzzle(kSudokuString);
-        REQUIRE_THAT(filled_puzzle[0], Equals(PuzzleRow_t{0, 0, 0, 8, 0, 5, 0, 0, 0}));
+        REQUIRE_THAT(filled_puzzle.GetRow(0), Equals(PuzzleRow_t{0, 0, 0, 8, 0, 5, 0, 0, 0}));
     }
 }
 
@@ -71,30 +74,136 @@ TEST_CASE("Puzzles can do rudimentary validity checking", "[puzzle]") {
     Puzzle puzzle;
     REQUIRE(puzzle.IsValid());
 
-    SECTION("Puzzles aren't valid if they contain too many cells") {
-        puzzle[0].push_back(0);
-        REQUIRE(!puzzle.IsValid());
+    SECTION("Puzzles can't be built with too many cells") {
+        REQUIRE_THROWS_AS(Puzzle(std::string(kTotalBoardSize + 1, kUnassignedChar)),
+                          std::invalid_argument);
     }
 
-    SECTION("Puzzles aren't valid if it contains too few cells") {
-        puzzle[0].pop_back();
-        REQUIRE(!puzzle.IsValid());
+    SECTION("Puzzles can't be built with too few cells") {
+        REQUIRE_THROWS_AS(Puzzle(std::string(kTotalBoardSize - 1, kUnassignedChar)),
+                          std::invalid_argument);
     }
 
-    SECTION("Puzzles aren't valid if rows aren't correct size") {
-        puzzle[0].pop_back();
-        puzzle[1].push_back(0);
-        REQUIRE(!puzzle.IsValid());
+    SECTION("Puzzles can't contain incorrect values") {
+        REQUIRE_THROWS_AS(puzzle.Set(0, 8, 10), std::invalid_argument);
+        REQUIRE_THROWS_AS(puzzle.Set(0, 8, -1), std::invalid_argument);
+        REQUIRE(puzzle.IsValid());
     }
 
-    SECTION("Puzzles aren't valid if they don't contain the correct characters") {
-        puzzle[0] = {1, 2, 3, 4, 5, 6, 7, 8, 10};
-        REQUIRE(!puzzle.IsValid());
+    SECTION("Puzzles are valid if they contain the correct characters") {
+        for (int col = 0; col < kBoardSize; ++col) {
+            puzzle.Set(0, col, col + 1);
+        }
+        REQUIRE(puzzle.IsValid());
     }
+}
 
-    SECTION("Puzzles are valid if they contain the correct characters") {
-        puzzle[0] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+TEST_CASE("Puzzles track validity incrementally", "[puzzle]") {
+    Puzzle puzzle(kSudokuString);
+    REQUIRE(puzzle.IsValid());
+    REQUIRE(puzzle.FilledCount() == 25);
+    REQUIRE_FALSE(puzzle.IsComplete());
+
+    SECTION("Setting a conflicting value invalidates the puzzle") {
+        // 8 is already in the first row
+        puzzle.Set(0, 0, 8);
+        REQUIRE_FALSE(puzzle.IsValid());
+        REQUIRE(puzzle.FilledCount() == 26);
+
+        SECTION("Clearing the conflict makes it valid again") {
+            puzzle.Clear(0, 0);
+            REQUIRE(puzzle.IsValid());
+            REQUIRE(puzzle.FilledCount() == 25);
+        }
+
+        SECTION("Overwriting the conflict makes it valid again") {
+            puzzle.Set(0, 0, 2);
+            REQUIRE(puzzle.IsValid());
+            REQUIRE(puzzle.FilledCount() == 26);
+        }
+    }
+
+    SECTION("Conflicts are counted per unit") {
+        puzzle.Set(0, 0, 8);
+        puzzle.Set(0, 1, 8);
+        puzzle.Clear(0, 3);
+        REQUIRE_FALSE(puzzle.IsValid());
+
+        puzzle.Clear(0, 1);
+        REQUIRE(puzzle.IsValid());
+    }
+
+    SECTION("IsValidAssignment uses the tracked counts") {
+        REQUIRE_FALSE(puzzle.IsValidAssignment({0, 0}, 8));
+        REQUIRE_FALSE(puzzle.IsValidAssignment({0, 0}, 1));
+        REQUIRE(puzzle.IsValidAssignment({0, 0}, 2));
+        REQUIRE(puzzle.IsValidAssignment({0, 3}, 8));
+    }
+
+    SECTION("Out of range values are rejected") {
+        REQUIRE_THROWS_AS(puzzle.Set(0, 0, 10), std::invalid_argument);
+        REQUIRE(puzzle.IsValid());
+    }
+
+}
+
+TEST_CASE("Puzzles can roll back to checkpoints", "[puzzle]") {
+    Puzzle puzzle(kSudokuString);
+    const Puzzle original(kSudokuString);
+
+    SECTION("Rollback restores the board and its bookkeeping") {
+        puzzle.Checkpoint();
+        puzzle.Assign(0, 8);
+        puzzle.Assign(1, 2);
+        puzzle.Unassign(5);
+        REQUIRE_FALSE(puzzle.IsValid());
+        REQUIRE(puzzle.Hash() != original.Hash());
+
+        puzzle.Rollback();
+        REQUIRE_THAT(puzzle.ToString(), Equals(kSudokuString));
         REQUIRE(puzzle.IsValid());
+        REQUIRE(puzzle.FilledCount() == original.FilledCount());
+        REQUIRE(puzzle.Hash() == original.Hash());
+        REQUIRE(puzzle.Candidates(0) == original.Candidates(0));
+    }
+
+    SECTION("Checkpoints nest") {
+        puzzle.Checkpoint();
+        puzzle.Assign(0, 2);
+
+        puzzle.Checkpoint();
+        puzzle.Assign(1, 4);
+        puzzle.Rollback();
+
+        REQUIRE(puzzle.GetCell(0) == 2);
+        REQUIRE(puzzle.GetCell(1) == kUnassigned);
+
+        puzzle.Rollback();
+        REQUIRE_THAT(puzzle.ToString(), Equals(kSudokuString));
+    }
+
+    SECTION("Committed changes belong to the enclosing checkpoint") {
+        puzzle.Checkpoint();
+        puzzle.Assign(0, 2);
+
+        puzzle.Checkpoint();
+        puzzle.Assign(1, 4);
+        puzzle.Commit();
+
+        REQUIRE(puzzle.GetCell(1) == 4);
+
+        puzzle.Rollback();
+        REQUIRE_THAT(puzzle.ToString(), Equals(kSudokuString));
+    }
+
+    SECTION("Equal boards hash equally") {
+        puzzle.Assign(0, 2);
+        REQUIRE(puzzle.Hash() == Puzzle("2" + kSudokuString.substr(1)).Hash());
+    }
+
+    SECTION("Candidates follow the masks") {
+        // row 0 holds 5 and 8, column 0 holds 1, box 0 holds 3 and 9
+        REQUIRE(puzzle.Candidates(0) == (Puzzle::Geometry::kAllValues & ~0x195));
     }
 }
 
@@ -102,7 +211,7 @@ TEST_CASE("Puzzles can be serialized and deserialized", "[puzzle]") {
     Puzzle puzzle;
     REQUIRE(puzzle.IsValid());
     REQUIRE(puzzle.Size() == kTotalBoardSize);
-    REQUIRE_THAT(puzzle[0], Equals(PuzzleRow_t(kBoardSize, 0)));
+    REQUIRE_THAT(puzzle.GetRow(0), Equals(PuzzleRow_t(kBoardSize, 0)));
 
     std::stringstream puzzle_stream(kSudokuString);
     puzzle_stream >> puzzle;
@@ -110,7 +219,7 @@ TEST_CASE("Puzzles can be serialized and deserialized", "[puzzle]") {
     SECTION("Puzzle can have a new board streamed in") {
         REQUIRE(puzzle.IsValid());
         REQUIRE(puzzle.Size() == kTotalBoardSize);
-        REQUIRE_THAT(puzzle[0], Equals(PuzzleRow_t{0, 0, 0, 8, 0, 5, 0, 0, 0}));
+        REQUIRE_THAT(puzzle.GetRow(0), Equals(PuzzleRow_t{0, 0, 0, 8, 0, 5, 0, 0, 0}));
     }
 
     SECTION("Puzzle can serialize back to original string") {
@@ -180,8 +289,7 @@ TEST_CASE("Puzzle class can build puzzle boards via BuildBoardVector", "[puzzle]
     }
 
     SECTION("Puzzle boards can't be built with invalid characters") {
-        PuzzleBoard_t built_board = Puzzle::BuildBoardVector(std::string(81, '0'));
-        REQUIRE_THAT(built_board, Equals(PuzzleBoard_t(kBoardSize, PuzzleRow_t(kBoardSize, '0'))));
+        REQUIRE_THROWS_AS(Puzzle::BuildBoardVector(std::string(81, '0')), std::invalid_argument);
     }
 
     SECTION("Puzzle boards can't be built from too-short strings") {
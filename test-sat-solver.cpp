@@ -0,0 +1,76 @@
+#include "band_solver.h"
+#include "catch.hpp"
+#include "sat_solver.h"
+
+using namespace Sudoku;
+
+namespace {
+const std::string kHardString =
+    "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9____4__";
+
+const std::string kConflictingString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
+
+// No conflicts between givens, but the first row has nowhere to put a 9
+const std::string kUnsolvableString =
+    "12345678_________9_______________________________________________________________";
+}  // namespace
+
+TEST_CASE("SAT solver solves puzzles", "[sat]") {
+    SatSolver sat;
+    REQUIRE(std::string(sat.Name()) == "sat");
+
+    SECTION("Hard 9x9 puzzle") {
+        Puzzle p(kHardString);
+        Puzzle expected(kHardString);
+        BandSolver band;
+
+        REQUIRE(sat.SolvePuzzle(p));
+        REQUIRE(band.SolvePuzzle(expected));
+        REQUIRE(p.ToString() == expected.ToString());
+    }
+
+    SECTION("Unsolvable puzzles") {
+        Puzzle conflicting(kConflictingString);
+        REQUIRE_FALSE(sat.SolvePuzzle(conflicting));
+
+        Puzzle unsolvable(kUnsolvableString);
+        REQUIRE_FALSE(sat.SolvePuzzle(unsolvable));
+        REQUIRE_FALSE(unsolvable.IsComplete());
+    }
+
+    SECTION("Conflicting puzzle after a hard one reports no conflicts") {
+        Puzzle hard(kHardString);
+        REQUIRE(sat.SolvePuzzle(hard));
+        REQUIRE(sat.LastNodes() > 0);
+
+        Puzzle conflicting(kConflictingString);
+        REQUIRE_FALSE(sat.SolvePuzzle(conflicting));
+        REQUIRE(sat.LastNodes() == 0);
+        REQUIRE(sat.LastConflicts() == 0);
+    }
+
+    SECTION("Empty larger boards") {
+        Puzzle16 p16;
+        SatSolver16 sat16;
+        REQUIRE(sat16.SolvePuzzle(p16));
+        REQUIRE(p16.IsComplete());
+        REQUIRE(p16.IsValid());
+
+        Puzzle25 p25;
+        SatSolver25 sat25;
+        REQUIRE(sat25.SolvePuzzle(p25));
+        REQUIRE(p25.IsComplete());
+        REQUIRE(p25.IsValid());
+    }
+}
+
+TEST_CASE("SAT solver runs batches through the engine interface", "[sat]") {
+    SatSolver sat;
+    Engine &engine = sat;
+    std::vector<Puzzle> puzzles{Puzzle(kHardString), Puzzle(kUnsolvableString), Puzzle()};
+
+    REQUIRE(engine.SolvePuzzles(puzzles) == std::vector<bool>{true, false, true});
+    REQUIRE(puzzles[0].IsComplete());
+    REQUIRE(puzzles[2].IsComplete());
+}
@@ -0,0 +1,195 @@
+#include "catch.hpp"
+#include "search_checkpoint.h"
+#include "solver.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Sudoku;
+
+namespace {
+// Takes the backtracking solver a few thousand nodes
+const std::string kHardString =
+    "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9____4__";
+
+// kHardString without its last given, which leaves several solutions
+const std::string kAmbiguousString =
+    "8__________36______7__9_2___5___7_______457_____1___3___1____68__85___1__9_______";
+}  // namespace
+
+TEST_CASE("Checkpoints round trip through text", "[checkpoint]") {
+    SearchCheckpoint checkpoint;
+    checkpoint.board = kHardString;
+    checkpoint.nodes = 1234;
+    checkpoint.lexicographic = true;
+    checkpoint.frames = {{1, 4, 0x160}, {2, 2, 0}};
+
+    std::stringstream text;
+    checkpoint.Write(text);
+    REQUIRE(PeekCheckpointBoxSize(text) == 3);
+
+    SearchCheckpoint read = SearchCheckpoint::Read(text);
+    REQUIRE(read.board == checkpoint.board);
+    REQUIRE(read.nodes == 1234);
+    REQUIRE(read.lexicographic);
+    REQUIRE(read.frames.size() == 2);
+    REQUIRE(read.frames[0].cell == 1);
+    REQUIRE(read.frames[0].value == 4);
+    REQUIRE(read.frames[0].remaining == 0x160);
+    REQUIRE(read.frames[1].cell == 2);
+}
+
+TEST_CASE("Version 1 checkpoints are read in the default order", "[checkpoint]") {
+    std::istringstream input("# sudoku-checkpoint 1\nbox 3\nboard " + kHardString +
+                             "\nnodes 12\nframes 1\n1 4 0\n");
+    REQUIRE(PeekCheckpointBoxSize(input) == 3);
+
+    SearchCheckpoint read = SearchCheckpoint::Read(input);
+    REQUIRE(read.nodes == 12);
+    REQUIRE_FALSE(read.lexicographic);
+    REQUIRE(read.frames.size() == 1);
+}
+
+TEST_CASE("Malformed checkpoints are rejected", "[checkpoint]") {
+    SearchCheckpoint checkpoint;
+    checkpoint.board = kHardString;
+    checkpoint.frames = {{1, 4, 0}};
+    std::ostringstream written;
+    checkpoint.Write(written);
+    const std::string text = written.str();
+
+    SECTION("Not a checkpoint") {
+        std::istringstream input("# spf1.0\n" + kHardString + "\n");
+        REQUIRE_THROWS_AS(SearchCheckpoint::Read(input), std::invalid_argument);
+    }
+
+    SECTION("Another board size") {
+        std::istringstream input(text);
+        REQUIRE_THROWS_AS(SearchCheckpoint16::Read(input), std::invalid_argument);
+    }
+
+    SECTION("Truncated") {
+        std::istringstream input(text.substr(0, text.size() - 7));
+        REQUIRE_THROWS_AS(SearchCheckpoint::Read(input), std::invalid_argument);
+    }
+
+    SECTION("Unknown search order") {
+        std::string bad = text;
+        bad.replace(bad.find("lexicographic 0"), 15, "lexicographic 2");
+        std::istringstream input(bad);
+        REQUIRE_THROWS_AS(SearchCheckpoint::Read(input), std::invalid_argument);
+    }
+
+    SECTION("Value out of range") {
+        std::string bad = text;
+        bad.replace(bad.rfind("1 4 0"), 5, "1 10 0");
+        std::istringstream input(bad);
+        REQUIRE_THROWS_AS(SearchCheckpoint::Read(input), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Solver searches resume from checkpoints", "[checkpoint]") {
+    Solver reference;
+    Puzzle expected(kHardString);
+    REQUIRE(reference.SolvePuzzle(expected));
+    const std::uint64_t total_nodes = reference.LastNodes();
+    REQUIRE(total_nodes > 100);
+
+    Solver solver;
+    std::vector<std::string> checkpoints;
+    solver.SetCheckpointHandler(total_nodes / 4, [&](const SearchCheckpoint &checkpoint) {
+        std::ostringstream text;
+        checkpoint.Write(text);
+        checkpoints.push_back(text.str());
+    });
+
+    SECTION("Checkpoints are taken at the interval") {
+        Puzzle puzzle(kHardString);
+        REQUIRE(solver.SolvePuzzle(puzzle));
+        REQUIRE(puzzle.ToString() == expected.ToString());
+        REQUIRE(checkpoints.size() >= 3);
+    }
+
+    SECTION("Any checkpoint finishes the same search") {
+        Puzzle puzzle(kHardString);
+        solver.SolvePuzzle(puzzle);
+        solver.SetCheckpointHandler(0, nullptr);
+
+        for (const auto &text : checkpoints) {
+            std::istringstream input(text);
+            SearchCheckpoint checkpoint = SearchCheckpoint::Read(input);
+            REQUIRE(checkpoint.board == kHardString);
+            REQUIRE_FALSE(checkpoint.frames.empty());
+
+            Puzzle resumed;
+            REQUIRE(solver.Resume(checkpoint, resumed));
+            REQUIRE(resumed.ToString() == expected.ToString());
+            REQUIRE(solver.LastNodes() == total_nodes);
+        }
+    }
+
+    SECTION("Stopping leaves the puzzle alone and checkpoints it") {
+        solver.SetCheckpointHandler(0, [&](const SearchCheckpoint &checkpoint) {
+            std::ostringstream text;
+            checkpoint.Write(text);
+            checkpoints.push_back(text.str());
+        });
+        solver.RequestStop();
+
+        Puzzle puzzle(kHardString);
+        REQUIRE_FALSE(solver.SolvePuzzle(puzzle));
+        REQUIRE(solver.LastInterrupted());
+        REQUIRE(puzzle.ToString() == kHardString);
+        REQUIRE(checkpoints.size() == 1);
+
+        // the request is used up
+        REQUIRE(solver.SolvePuzzle(puzzle));
+        REQUIRE_FALSE(solver.LastInterrupted());
+    }
+
+    SECTION("Checkpoints that don't fit their board are rejected") {
+        SearchCheckpoint checkpoint;
+        checkpoint.board = kHardString;
+        // cell 0 is a given
+        checkpoint.frames = {{0, 1, 0}};
+
+        Puzzle puzzle;
+        REQUIRE_THROWS_AS(solver.Resume(checkpoint, puzzle), std::invalid_argument);
+
+        // 8 is already in the first row
+        checkpoint.frames = {{1, 8, 0}};
+        REQUIRE_THROWS_AS(solver.Resume(checkpoint, puzzle), std::invalid_argument);
+    }
+}
+
+TEST_CASE("Resumed searches keep their checkpoint's order", "[checkpoint]") {
+    Solver reference;
+    reference.SetLexicographic(true);
+    Puzzle expected(kAmbiguousString);
+    REQUIRE(reference.SolvePuzzle(expected));
+    const std::uint64_t total_nodes = reference.LastNodes();
+    REQUIRE(total_nodes > 10);
+
+    Solver solver;
+    solver.SetLexicographic(true);
+    std::vector<SearchCheckpoint> checkpoints;
+    solver.SetCheckpointHandler(total_nodes / 4, [&](const SearchCheckpoint &checkpoint) {
+        checkpoints.push_back(checkpoint);
+    });
+    Puzzle puzzle(kAmbiguousString);
+    REQUIRE(solver.SolvePuzzle(puzzle));
+    REQUIRE_FALSE(checkpoints.empty());
+
+    // a solver in the default order still finishes the lexicographic search
+    Solver resumer;
+    for (const auto &checkpoint : checkpoints) {
+        REQUIRE(checkpoint.lexicographic);
+
+        Puzzle resumed;
+        REQUIRE(resumer.Resume(checkpoint, resumed));
+        REQUIRE(resumed.ToString() == expected.ToString());
+        REQUIRE(resumer.LastNodes() == total_nodes);
+    }
+}
@@ -0,0 +1,317 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "server.h"
+#include "solver.h"
+
+using namespace Sudoku;
+
+namespace {
+const std::string kPuzzleString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______6___";
+
+const std::string kConflictingString =
+    "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
+
+ServerOptions TestOptions() {
+    ServerOptions options;
+    options.socket_path = std::string(std::tmpnam(nullptr)) + ".sock";
+    options.threads = 2;
+    return options;
+}
+
+int Connect(const std::string &path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path.c_str());
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+        close(fd);
+        throw std::runtime_error("connect failed");
+    }
+
+    return fd;
+}
+
+// Reads from fd until expected_lines lines have come back
+std::string ReadLines(const int fd, const int expected_lines) {
+    std::string response;
+    char chunk[1024];
+    int lines = 0;
+    while (lines < expected_lines) {
+        ssize_t count = read(fd, chunk, sizeof(chunk));
+        if (count <= 0) {
+            break;
+        }
+        for (ssize_t i = 0; i < count; ++i) {
+            lines += (chunk[i] == '\n') ? 1 : 0;
+        }
+        response.append(chunk, static_cast<std::size_t>(count));
+    }
+
+    return response;
+}
+
+// Sends the request to the server's socket and reads until expected_lines
+// lines have come back
+std::string Exchange(const std::string &path, const std::string &request,
+                     const int expected_lines) {
+    int fd = Connect(path);
+    REQUIRE(write(fd, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+
+    std::string response = ReadLines(fd, expected_lines);
+    close(fd);
+    return response;
+}
+}  // namespace
+
+TEST_CASE("Server answers request lines", "[server]") {
+    Server server(TestOptions());
+    std::string reply;
+
+    Puzzle expected(kPuzzleString);
+    Solver().SolvePuzzle(expected);
+
+    REQUIRE(server.HandleLine(kPuzzleString, reply));
+    REQUIRE(reply == expected.ToString());
+
+    SECTION("Repeated puzzles come from the cache") {
+        REQUIRE(server.HandleLine(kPuzzleString, reply));
+        REQUIRE(reply == expected.ToString());
+        REQUIRE(server.Cache().Hits() == 1);
+    }
+
+    SECTION("Unsolvable and malformed puzzles") {
+        REQUIRE(server.HandleLine(kConflictingString, reply));
+        REQUIRE(reply == kUnsolvableReply);
+
+        REQUIRE(server.HandleLine("12345", reply));
+        REQUIRE(reply.find("error: ") == 0);
+    }
+
+    SECTION("Headers and blank lines get no reply") {
+        REQUIRE_FALSE(server.HandleLine("# spf1.0", reply));
+        REQUIRE_FALSE(server.HandleLine("", reply));
+    }
+}
+
+TEST_CASE("Line reader hands out lines as ranges of its buffer", "[server]") {
+    LineReader reader;
+    std::vector<LineRange> lines;
+    auto append = [&](const std::string &data) { reader.Append(data.data(), data.size()); };
+    auto text = [&](const LineRange &line) {
+        return std::string(reader.Data() + line.offset, line.length);
+    };
+
+    // lines split across appends, with either line ending
+    append("first\r\nsec");
+    reader.TakeLines(lines);
+    REQUIRE(lines.size() == 1);
+    append("ond\n\nlast");
+    reader.TakeLines(lines);
+    REQUIRE(lines.size() == 3);
+    REQUIRE(text(lines[0]) == "first");
+    REQUIRE(text(lines[1]) == "second");
+    REQUIRE(text(lines[2]).empty());
+
+    // the unfinished line survives Consume
+    reader.Consume();
+    lines.clear();
+    append("\n");
+    reader.TakeLines(lines);
+    REQUIRE(lines.size() == 1);
+    REQUIRE(text(lines[0]) == "last");
+    reader.Consume();
+
+    SECTION("Long lines are cut short and the rest skipped") {
+        lines.clear();
+        const std::string long_line(kMaxLineLength + 10, '_');
+        append(long_line);
+        reader.TakeLines(lines);
+        REQUIRE(lines.size() == 1);
+        REQUIRE(lines[0].length == kMaxLineLength + 1);
+
+        reader.Consume();
+        lines.clear();
+        append(long_line);
+        append("__\nnext\n");
+        reader.TakeLines(lines);
+        REQUIRE(lines.size() == 1);
+        REQUIRE(text(lines[0]) == "next");
+    }
+}
+
+TEST_CASE("Server rejects unknown engines", "[server]") {
+    ServerOptions options = TestOptions();
+    options.engine = "magic";
+    REQUIRE_THROWS_AS(Server(options), std::invalid_argument);
+}
+
+TEST_CASE("Server serves clients over its socket", "[server]") {
+    ServerOptions options = TestOptions();
+    Server server(options);
+    server.Listen();
+    std::thread runner([&] { server.Run(); });
+
+    Puzzle expected(kPuzzleString);
+    Solver().SolvePuzzle(expected);
+
+    std::string response =
+        Exchange(options.socket_path,
+                 "# spf1.0\n" + kPuzzleString + "\r\n" + kConflictingString + "\nbad\n", 3);
+    REQUIRE(response.substr(0, 82) == expected.ToString() + "\n");
+    REQUIRE(response.substr(82, kUnsolvableReply.size() + 1) == kUnsolvableReply + "\n");
+    REQUIRE(response.find("error: ", 82) != std::string::npos);
+
+    // a second client on the warm server
+    REQUIRE(Exchange(options.socket_path, kPuzzleString + "\n", 1) == expected.ToString() + "\n");
+
+    server.Stop();
+    runner.join();
+}
+
+TEST_CASE("Server keeps idle connections open alongside busy ones", "[server]") {
+    ServerOptions options = TestOptions();
+    Server server(options);
+    server.Listen();
+    std::thread runner([&] { server.Run(); });
+
+    Puzzle expected(kPuzzleString);
+    Solver().SolvePuzzle(expected);
+
+    std::vector<int> idle;
+    for (int i = 0; i < 200; ++i) {
+        idle.push_back(Connect(options.socket_path));
+    }
+
+    // a line arriving in pieces is only answered once it is complete
+    int fd = Connect(options.socket_path);
+    const std::string first = kPuzzleString.substr(0, 40);
+    const std::string rest = kPuzzleString.substr(40) + "\n" + kPuzzleString + "\n";
+    REQUIRE(write(fd, first.data(), first.size()) == static_cast<ssize_t>(first.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(write(fd, rest.data(), rest.size()) == static_cast<ssize_t>(rest.size()));
+    REQUIRE(ReadLines(fd, 2) == expected.ToString() + "\n" + expected.ToString() + "\n");
+    REQUIRE(server.ConnectionCount() == idle.size() + 1);
+
+    // an idle connection can still be used
+    REQUIRE(write(idle[100], "bad\n", 4) == 4);
+    REQUIRE(ReadLines(idle[100], 1).find("error: ") == 0);
+
+    close(fd);
+    for (const int idle_fd : idle) {
+        close(idle_fd);
+    }
+
+    server.Stop();
+    runner.join();
+    REQUIRE(server.ConnectionCount() == 0);
+}
+
+TEST_CASE("Server answers lines that are too long with an error", "[server]") {
+    ServerOptions options = TestOptions();
+    Server server(options);
+    server.Listen();
+    std::thread runner([&] { server.Run(); });
+
+    Puzzle expected(kPuzzleString);
+    Solver().SolvePuzzle(expected);
+
+    // the long line is answered before its newline arrives, and the
+    // connection carries on after it
+    int fd = Connect(options.socket_path);
+    const std::string long_line(100000, '_');
+    REQUIRE(write(fd, long_line.data(), long_line.size()) ==
+            static_cast<ssize_t>(long_line.size()));
+    REQUIRE(ReadLines(fd, 1) == "error: line too long\n");
+
+    const std::string rest = "___\n" + kPuzzleString + "\n";
+    REQUIRE(write(fd, rest.data(), rest.size()) == static_cast<ssize_t>(rest.size()));
+    REQUIRE(ReadLines(fd, 1) == expected.ToString() + "\n");
+    close(fd);
+
+    server.Stop();
+    runner.join();
+}
+
+TEST_CASE("Server replies to a group of lines in order", "[server]") {
+    Server server(TestOptions());
+    Puzzle expected(kPuzzleString);
+    Solver().SolvePuzzle(expected);
+
+    std::string replies;
+    server.HandleLines({kPuzzleString, "# comment", kConflictingString, "bad", kPuzzleString},
+                       replies);
+
+    std::istringstream stream(replies);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(stream, line);) {
+        lines.push_back(line);
+    }
+
+    REQUIRE(lines.size() == 4);
+    REQUIRE(lines[0] == expected.ToString());
+    REQUIRE(lines[1] == kUnsolvableReply);
+    REQUIRE(lines[2].find("error: ") == 0);
+    REQUIRE(lines[3] == expected.ToString());
+}
+
+TEST_CASE("Server answers shed puzzles as overloaded", "[server]") {
+    ServerOptions options = TestOptions();
+    options.batch.max_pending = 1;
+    options.batch.max_wait = std::chrono::milliseconds(50);
+    Server server(options);
+
+    std::string replies;
+    server.HandleLines({kPuzzleString, kConflictingString}, replies);
+
+    std::istringstream stream(replies);
+    std::string first;
+    std::string second;
+    std::getline(stream, first);
+    std::getline(stream, second);
+    REQUIRE(first.size() == 81);
+    REQUIRE(second == kOverloadedReply);
+    REQUIRE(server.Batcher().Stats().rejected == 1);
+
+    // overloaded replies aren't cached
+    std::string reply;
+    REQUIRE(server.HandleLine(kConflictingString, reply));
+    REQUIRE(reply == kUnsolvableReply);
+}
+
+TEST_CASE("Server reports its metrics", "[server]") {
+    // the test puzzle only needs singles, so triage would finish it before
+    // it reached the engine
+    ServerOptions options = TestOptions();
+    options.batch.triage = false;
+    Server server(options);
+    std::string reply;
+    REQUIRE(server.HandleLine(kPuzzleString, reply));
+    REQUIRE(server.HandleLine(kPuzzleString, reply));
+
+    std::string text;
+    server.WriteMetrics(text);
+
+    REQUIRE(text.find("sudoku_solves_total{engine=\"band\",path=\"batch\",result=\"solved\"} 1\n") !=
+            std::string::npos);
+    REQUIRE(text.find("sudoku_solve_duration_seconds_count{engine=\"band\",path=\"batch\"} 1\n") !=
+            std::string::npos);
+    REQUIRE(text.find("sudoku_cache_hits_total 1\n") != std::string::npos);
+    REQUIRE(text.find("sudoku_cache_hit_ratio 0.5\n") != std::string::npos);
+    REQUIRE(text.find("sudoku_queue_depth 0\n") != std::string::npos);
+    REQUIRE(text.find("sudoku_triaged_total 0\n") != std::string::npos);
+    REQUIRE(text.find("# TYPE sudoku_solve_nodes histogram\n") != std::string::npos);
+}
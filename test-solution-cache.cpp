@@ -0,0 +1,35 @@
+#include "catch.hpp"
+#include "solution_cache.h"
+
+using namespace Sudoku;
+
+TEST_CASE("Solution cache remembers answers", "[cache]") {
+    SolutionCache cache(8);
+    std::string solution;
+
+    REQUIRE_FALSE(cache.Lookup(1, "puzzle", solution));
+    cache.Insert(1, "puzzle", "solved");
+    REQUIRE(cache.Lookup(1, "puzzle", solution));
+    REQUIRE(solution == "solved");
+
+    SECTION("Hash collisions don't mix up puzzles") {
+        REQUIRE_FALSE(cache.Lookup(1, "other", solution));
+        cache.Insert(9, "other", "");
+        REQUIRE(cache.Lookup(9, "other", solution));
+        REQUIRE(solution.empty());
+        REQUIRE_FALSE(cache.Lookup(1, "puzzle", solution));
+    }
+
+    SECTION("Hits and misses are counted") {
+        REQUIRE(cache.Hits() == 1);
+        REQUIRE(cache.Misses() == 1);
+    }
+}
+
+TEST_CASE("Empty solution caches never hit", "[cache]") {
+    SolutionCache cache(0);
+    std::string solution;
+
+    cache.Insert(1, "puzzle", "solved");
+    REQUIRE_FALSE(cache.Lookup(1, "puzzle", solution));
+}
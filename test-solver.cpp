@@ -8,6 +8,20 @@ const std::string kSudokuString =
 const std::string kInvalidSudokuString =
     "___8_5____3__6___7_9___38___4795_3______71_9____2__5__1____248___9____5______66__";
 
+const std::string kSudoku16String =
+    "__F___C_31___4_7_6_831____B_D_F_31_AG__7DE__5_C____7DEF2_6_____A_F25________4B7D6C83_9A_"
+    "4B_____51_AG4__D______834B7DE_2__C8_1_A______8_1_AG4B7D___31_A____DE_25_9_G4B__E___6C_31B__"
+    "___56____9A__25_C8__9_G_B___F8_1__G4_7DEF25__AG4_7_E__5__8_____E_2__C8___A___";
+
+const std::string kSudoku25String =
+    "HDL_J864__9A_C_G5_I_E_M___64N3_ABC___2IKEPM7____F_____1G___KEP___HD___8_4N_G____E_M_O__LFJ"
+    "86_N3_AB_1E_M7OHDL_J8_4N39AB___52IKDLF_864N3_ABC____I____7____N3_ABC__52I__P____DL__8__C_G"
+    "52___PM__HD_FJ8_4_3___I_EPM__HDLFJ___N__A_C1G_M7OH__FJ8_4N__A____52I________N3__BC1_52IK_P"
+    "__O_D4_39_BC1G52_K_PM_O_DL___6BC1_52__EP_7__D_FJ_6_N39A2I_EPM_O_DL__8_4__9_BC1G_M7O_DLF_8_"
+    "4N3__B_1G52I___FJ__4_39A_C_G5_IKEP_7_HD__3_A_C_G__IKEPM7_HDLFJ8_4_1G52_KEPM7O__LFJ86__39AB"
+    "IK_P_7___LF_86_____BC1_52_OHD_F_8_4N3_ABC__5_I_EPM_86_N_9A__1__2_KE__7O_DLF3_AB_1_5_IK_PM_"
+    "__DLF_864N1_____E____HDLF_86_N_9_B___PM7_HDLF_864____B__G5_IO_DLFJ_64N3_A_C_G_2I__PM7";
+
 using namespace Sudoku;
 TEST_CASE("Solver can solve puzzles") {
     Solver s;
@@ -15,10 +29,92 @@ TEST_CASE("Solver can solve puzzles") {
     SECTION("Valid puzzle") {
         Puzzle p(kSudokuString);
         REQUIRE(s.SolvePuzzle(p));
+        REQUIRE(p.IsValid());
+        REQUIRE(p.FindUnassignedPosition() == PuzzleCoord_t{-1, -1});
     }
 
     SECTION("Invalid Puzzle") {
         Puzzle p(kInvalidSudokuString);
         REQUIRE_FALSE(s.SolvePuzzle(p));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Solver can solve larger boards") {
+    SECTION("16x16 puzzle") {
+        Solver16 s;
+        Puzzle16 p(kSudoku16String);
+        REQUIRE(s.SolvePuzzle(p));
+        REQUIRE(p.IsValid());
+        REQUIRE(p.FindUnassignedPosition() == PuzzleCoord_t{-1, -1});
+    }
+
+    SECTION("25x25 puzzle") {
+        Solver25 s;
+        Puzzle25 p(kSudoku25String);
+        REQUIRE(s.SolvePuzzle(p));
+        REQUIRE(p.IsValid());
+        REQUIRE(p.FindUnassignedPosition() == PuzzleCoord_t{-1, -1});
+    }
+}
+
+TEST_CASE("Solver can be reused across a batch") {
+    Solver s;
+    std::vector<Puzzle> puzzles{Puzzle(kSudokuString), Puzzle(kInvalidSudokuString),
+                                Puzzle(kSudokuString), Puzzle()};
+
+    std::vector<bool> results = s.SolvePuzzles(puzzles);
+
+    REQUIRE(results == std::vector<bool>{true, false, true, true});
+    REQUIRE(puzzles[0].IsComplete());
+    REQUIRE(puzzles[0].ToString() == puzzles[2].ToString());
+    REQUIRE(puzzles[3].IsComplete());
+
+    SECTION("Solved puzzles don't hold on to the solver's arena") {
+        Puzzle copy = puzzles[0];
+        copy.Checkpoint();
+        copy.Unassign(0);
+        copy.Rollback();
+        REQUIRE(copy.IsComplete());
+    }
+}
+
+TEST_CASE("Solver finds the lexicographically first solution") {
+    Solver s;
+    Engine &engine = s;
+    REQUIRE(engine.SetLexicographic(true));
+
+    Puzzle p;
+    REQUIRE(s.SolvePuzzle(p));
+    REQUIRE(p.ToString() ==
+            "123456789456789123789123456214365897365897214897214365531642978642978531978531642");
+
+    SECTION("Puzzles with one solution are unaffected") {
+        Puzzle lexicographic(kSudokuString);
+        Puzzle fewest_first(kSudokuString);
+        REQUIRE(s.SolvePuzzle(lexicographic));
+        s.SetLexicographic(false);
+        REQUIRE(s.SolvePuzzle(fewest_first));
+        REQUIRE(lexicographic.ToString() == fewest_first.ToString());
+    }
+}
+
+TEST_CASE("Solver gives up at its node limit") {
+    Solver s;
+    Puzzle p(kSudokuString);
+    REQUIRE(s.SolvePuzzle(p));
+    const std::uint64_t needed = s.LastNodes();
+    REQUIRE(needed > 1);
+
+    s.SetNodeLimit(needed - 1);
+    Puzzle limited(kSudokuString);
+    REQUIRE_FALSE(s.SolvePuzzle(limited));
+    REQUIRE(s.LastBudgetExhausted());
+    REQUIRE(limited.ToString() == Puzzle(kSudokuString).ToString());
+
+    SECTION("The puzzle can still be solved afterwards") {
+        s.SetNodeLimit(0);
+        REQUIRE(s.SolvePuzzle(limited));
+        REQUIRE_FALSE(s.LastBudgetExhausted());
+        REQUIRE(limited.ToString() == p.ToString());
+    }
+}
@@ -0,0 +1,36 @@
+#include <atomic>
+#include <set>
+
+#include "catch.hpp"
+#include "thread_pool.h"
+
+using namespace Sudoku;
+
+TEST_CASE("Thread pool runs every task", "[pool]") {
+    std::atomic<int> total{0};
+    std::mutex mutex;
+    std::set<unsigned> workers;
+
+    {
+        ThreadPool pool(4);
+        REQUIRE(pool.Size() == 4);
+
+        for (int i = 1; i <= 100; ++i) {
+            pool.Submit([&, i](const unsigned worker) {
+                total += i;
+                std::lock_guard<std::mutex> lock(mutex);
+                workers.insert(worker);
+            });
+        }
+    }
+
+    REQUIRE(total == 5050);
+    for (const unsigned worker : workers) {
+        REQUIRE(worker < 4);
+    }
+}
+
+TEST_CASE("Thread pool defaults to the hardware thread count", "[pool]") {
+    ThreadPool pool;
+    REQUIRE(pool.Size() >= 1);
+}
@@ -0,0 +1,64 @@
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "catch.hpp"
+#include "trace.h"
+
+using namespace Sudoku;
+
+namespace {
+std::size_t Occurrences(const std::string &text, const std::string &pattern) {
+    std::size_t count = 0;
+    for (std::size_t at = text.find(pattern); at != std::string::npos;
+         at = text.find(pattern, at + 1)) {
+        ++count;
+    }
+
+    return count;
+}
+}  // namespace
+
+TEST_CASE("Trace scopes become Chrome trace events", "[trace]") {
+    ClearTrace();
+
+    {
+        TraceScope outer("search");
+        TraceScope inner("propagate");
+    }
+    std::thread([] { TraceScope scope("output"); }).join();
+    REQUIRE(TraceEventCount() == 3);
+
+    std::ostringstream out;
+    WriteChromeTrace(out);
+    const std::string trace = out.str();
+
+    REQUIRE(trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+    REQUIRE(trace.substr(trace.size() - 4) == "\n]}\n");
+    REQUIRE(Occurrences(trace, "\"ph\":\"X\"") == 3);
+    REQUIRE(Occurrences(trace, "{\"name\":\"search\"") == 1);
+    REQUIRE(Occurrences(trace, "{\"name\":\"propagate\"") == 1);
+    REQUIRE(Occurrences(trace, "{\"name\":\"output\"") == 1);
+
+    ClearTrace();
+    REQUIRE(TraceEventCount() == 0);
+}
+
+TEST_CASE("Trace buffers keep the latest events", "[trace]") {
+    ClearTrace();
+
+    for (std::size_t i = 0; i < kTraceBufferSize + 10; ++i) {
+        RecordTraceEvent(i < 10 ? "old" : "new", i, i + 1);
+    }
+    REQUIRE(TraceEventCount() == kTraceBufferSize);
+
+    std::ostringstream out;
+    WriteChromeTrace(out);
+    REQUIRE(out.str().find("\"old\"") == std::string::npos);
+    REQUIRE(out.str().find("{\"name\":\"new\",\"ph\":\"X\",\"pid\":1,\"tid\":") !=
+            std::string::npos);
+    // timestamps are microseconds from the earliest event
+    REQUIRE(out.str().find(",\"ts\":0.000,\"dur\":") != std::string::npos);
+
+    ClearTrace();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sudoku {
+
+// Fixed set of worker threads running queued tasks. Tasks are told which
+// worker runs them, so callers can keep per-worker state (engines, arenas)
+// warm across tasks without locking.
+class ThreadPool {
+   public:
+    using Task = std::function<void(unsigned worker)>;
+
+    // Starts the given number of workers, or one per hardware thread if 0
+    explicit ThreadPool(unsigned threads = 0);
+
+    // Runs every task already queued, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned Size() const { return static_cast<unsigned>(workers_.size()); }
+
+    void Submit(Task task);
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    void Work(const unsigned worker);
+};
+}  // namespace Sudoku
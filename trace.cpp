@@ -0,0 +1,168 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sudoku {
+
+namespace {
+struct TraceEvent {
+    const char *name;
+    std::uint64_t start;
+    std::uint64_t end;
+};
+
+// One thread's events. Only the owning thread writes to it; the registry
+// keeps it alive after the thread exits so its events can still be written.
+struct TraceBuffer {
+    unsigned thread;
+    std::unique_ptr<TraceEvent[]> events{new TraceEvent[kTraceBufferSize]};
+    // events ever recorded; the latest is at (recorded - 1) % kTraceBufferSize
+    std::atomic<std::uint64_t> recorded{0};
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+
+    // TraceClock and steady_clock read together when tracing started, to
+    // work out how long a tick is
+    std::uint64_t first_tick = TraceClock();
+    std::chrono::steady_clock::time_point first_time = std::chrono::steady_clock::now();
+
+    // Nanoseconds per TraceClock tick
+    double TickLength() {
+        if (!TicksAreCycles()) {
+            return 1.0;
+        }
+
+        // a short baseline would make for a rough estimate
+        const auto baseline = std::chrono::milliseconds(10);
+        if (std::chrono::steady_clock::now() < first_time + baseline) {
+            std::this_thread::sleep_until(first_time + baseline);
+        }
+
+        const std::uint64_t ticks = TraceClock() - first_tick;
+        const auto elapsed = std::chrono::steady_clock::now() - first_time;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / ticks;
+    }
+
+    static bool TicksAreCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return true;
+#else
+        return false;
+#endif
+    }
+};
+
+TraceRegistry &Registry() {
+    static TraceRegistry registry;
+    return registry;
+}
+
+TraceBuffer &ThreadBuffer() {
+    // The registry owns the buffers, so a plain pointer (cheaper to reach
+    // than a thread_local with a destructor) is enough here
+    thread_local TraceBuffer *buffer = nullptr;
+    if (buffer == nullptr) {
+        std::shared_ptr<TraceBuffer> created = std::make_shared<TraceBuffer>();
+
+        TraceRegistry &registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        created->thread = static_cast<unsigned>(registry.buffers.size()) + 1;
+        registry.buffers.push_back(created);
+        buffer = created.get();
+    }
+
+    return *buffer;
+}
+
+// Writes a name as a JSON string. Trace names are plain identifiers, but
+// quotes and backslashes are escaped anyway.
+void WriteName(std::ostream &out, const char *name) {
+    out << '"';
+    for (const char *c = name; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\';
+        }
+        out << *c;
+    }
+    out << '"';
+}
+}  // namespace
+
+void RecordTraceEvent(const char *name, const std::uint64_t start, const std::uint64_t end) {
+    TraceBuffer &buffer = ThreadBuffer();
+    const std::uint64_t recorded = buffer.recorded.load(std::memory_order_relaxed);
+
+    buffer.events[recorded % kTraceBufferSize] = TraceEvent{name, start, end};
+    buffer.recorded.store(recorded + 1, std::memory_order_release);
+}
+
+void WriteChromeTrace(std::ostream &out) {
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const double tick_length = registry.TickLength();
+
+    // timestamps start from the earliest event to keep the numbers short
+    std::uint64_t origin = ~std::uint64_t{0};
+    for (auto &buffer : registry.buffers) {
+        const std::uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+        const std::uint64_t first = recorded - std::min<std::uint64_t>(recorded, kTraceBufferSize);
+        for (std::uint64_t i = first; i < recorded; ++i) {
+            origin = std::min(origin, buffer->events[i % kTraceBufferSize].start);
+        }
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first_event = true;
+    for (auto &buffer : registry.buffers) {
+        const std::uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+        const std::uint64_t first = recorded - std::min<std::uint64_t>(recorded, kTraceBufferSize);
+
+        for (std::uint64_t i = first; i < recorded; ++i) {
+            const TraceEvent &event = buffer->events[i % kTraceBufferSize];
+
+            // complete ("X") events, with times in microseconds
+            char times[64];
+            std::snprintf(times, sizeof(times), ",\"ts\":%.3f,\"dur\":%.3f}",
+                          (event.start - origin) * tick_length / 1000.0,
+                          (event.end - event.start) * tick_length / 1000.0);
+
+            out << (first_event ? "\n" : ",\n") << "{\"name\":";
+            WriteName(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread << times;
+            first_event = false;
+        }
+    }
+    out << "\n]}\n";
+}
+
+std::size_t TraceEventCount() {
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    std::size_t count = 0;
+    for (auto &buffer : registry.buffers) {
+        const std::uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+        count += static_cast<std::size_t>(std::min<std::uint64_t>(recorded, kTraceBufferSize));
+    }
+
+    return count;
+}
+
+void ClearTrace() {
+    TraceRegistry &registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (auto &buffer : registry.buffers) {
+        buffer->recorded.store(0, std::memory_order_relaxed);
+    }
+}
+}  // namespace Sudoku